@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "wasm-instruction.h"
+
+namespace wasm::detail {
+	/* constexpr description of the binary opcode, text mnemonic, and type-signature of a single instruction
+	*	Note: instructions with custom type-checking (such as drop or select) only describe their encoding */
+	struct InstInfo {
+		std::u8string_view name;
+		uint8_t code[3] = { 0, 0, 0 };
+		wasm::Type pop[3] = { wasm::Type::i32, wasm::Type::i32, wasm::Type::i32 };
+		wasm::Type push = wasm::Type::i32;
+		uint8_t codeSize = 0;
+		uint8_t popCount = 0;
+		uint8_t pushCount = 0;
+		bool custom = false;
+	};
+
+	constexpr detail::InstInfo MakeInfo(std::u8string_view name, std::initializer_list<uint8_t> code) {
+		detail::InstInfo info;
+		info.name = name;
+		for (uint8_t byte : code)
+			info.code[info.codeSize++] = byte;
+		info.custom = true;
+		return info;
+	}
+	constexpr detail::InstInfo MakeInfo(std::u8string_view name, std::initializer_list<uint8_t> code, std::initializer_list<wasm::Type> pop, std::initializer_list<wasm::Type> push) {
+		detail::InstInfo info = detail::MakeInfo(name, code);
+		for (wasm::Type type : pop)
+			info.pop[info.popCount++] = type;
+		for (wasm::Type type : push) {
+			info.push = type;
+			++info.pushCount;
+		}
+		info.custom = false;
+		return info;
+	}
+
+	/* descriptions indexed by wasm::InstSimple::Type */
+	inline constexpr detail::InstInfo SimpleInfo[] = {
+		detail::MakeInfo(u8"drop", { 0x1a }), /* drop */
+		detail::MakeInfo(u8"nop", { 0x01 }, {}, {}), /* nop */
+		detail::MakeInfo(u8"return", { 0x0f }), /* ret */
+		detail::MakeInfo(u8"unreachable", { 0x00 }), /* unreachable */
+		detail::MakeInfo(u8"select", { 0x1b }), /* select */
+		detail::MakeInfo(u8"select (result funcref)", { 0x1c, 0x01, 0x70 }, { wasm::Type::refFunction, wasm::Type::refFunction, wasm::Type::i32 }, { wasm::Type::refFunction }), /* selectRefFunction */
+		detail::MakeInfo(u8"select (result externref)", { 0x1c, 0x01, 0x6f }, { wasm::Type::refExtern, wasm::Type::refExtern, wasm::Type::i32 }, { wasm::Type::refExtern }), /* selectRefExtern */
+		detail::MakeInfo(u8"ref.is_null", { 0xd1 }), /* refTestNull */
+		detail::MakeInfo(u8"ref.null func", { 0xd0, 0x70 }, {}, { wasm::Type::refFunction }), /* refNullFunction */
+		detail::MakeInfo(u8"ref.null extern", { 0xd0, 0x6f }, {}, { wasm::Type::refExtern }), /* refNullExtern */
+		detail::MakeInfo(u8"i64.extend_i32_s", { 0xac }, { wasm::Type::i32 }, { wasm::Type::i64 }), /* expandIntSigned */
+		detail::MakeInfo(u8"i64.extend_i32_u", { 0xad }, { wasm::Type::i32 }, { wasm::Type::i64 }), /* expandIntUnsigned */
+		detail::MakeInfo(u8"i32.wrap_i64", { 0xa7 }, { wasm::Type::i64 }, { wasm::Type::i32 }), /* shrinkInt */
+		detail::MakeInfo(u8"f64.promote_f32", { 0xbb }, { wasm::Type::f32 }, { wasm::Type::f64 }), /* expandFloat */
+		detail::MakeInfo(u8"f32.demote_f64", { 0xb6 }, { wasm::Type::f64 }, { wasm::Type::f32 }) /* shrinkFloat */
+	};
+
+	/* descriptions indexed by [wasm::InstOperand::Type * 4 + wasm::OpType] */
+	inline constexpr detail::InstInfo OperandInfo[] = {
+		detail::MakeInfo(u8"i32.eq", { 0x46 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* equal */
+		detail::MakeInfo(u8"i64.eq", { 0x51 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f32.eq", { 0x5b }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f64.eq", { 0x61 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.ne", { 0x47 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* notEqual */
+		detail::MakeInfo(u8"i64.ne", { 0x52 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f32.ne", { 0x5c }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f64.ne", { 0x62 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.add", { 0x6a }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* add */
+		detail::MakeInfo(u8"i64.add", { 0x7c }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"f32.add", { 0x92 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::f32 }),
+		detail::MakeInfo(u8"f64.add", { 0xa0 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"i32.sub", { 0x6b }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* sub */
+		detail::MakeInfo(u8"i64.sub", { 0x7d }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"f32.sub", { 0x93 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::f32 }),
+		detail::MakeInfo(u8"f64.sub", { 0xa1 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"i32.mul", { 0x6c }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* mul */
+		detail::MakeInfo(u8"i64.mul", { 0x7e }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"f32.mul", { 0x94 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::f32 }),
+		detail::MakeInfo(u8"f64.mul", { 0xa2 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::f64 })
+	};
+
+	/* descriptions indexed by [wasm::InstWidth::Type * 2 + (width32 ? 0 : 1)] */
+	inline constexpr detail::InstInfo WidthInfo[] = {
+		detail::MakeInfo(u8"i32.eqz", { 0x45 }, { wasm::Type::i32 }, { wasm::Type::i32 }), /* equalZero */
+		detail::MakeInfo(u8"i64.eqz", { 0x50 }, { wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f32.gt", { 0x5e }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::i32 }), /* greater */
+		detail::MakeInfo(u8"f64.gt", { 0x64 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f32.lt", { 0x5d }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::i32 }), /* less */
+		detail::MakeInfo(u8"f64.lt", { 0x63 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f32.ge", { 0x60 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::i32 }), /* greaterEqual */
+		detail::MakeInfo(u8"f64.ge", { 0x66 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"f32.le", { 0x5f }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::i32 }), /* lessEqual */
+		detail::MakeInfo(u8"f64.le", { 0x65 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.gt_s", { 0x4a }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* greaterSigned */
+		detail::MakeInfo(u8"i64.gt_s", { 0x55 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.gt_u", { 0x4b }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* greaterUnsigned */
+		detail::MakeInfo(u8"i64.gt_u", { 0x56 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.lt_s", { 0x48 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* lessSigned */
+		detail::MakeInfo(u8"i64.lt_s", { 0x53 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.lt_u", { 0x49 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* lessUnsigned */
+		detail::MakeInfo(u8"i64.lt_u", { 0x54 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.ge_s", { 0x4e }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* greaterEqualSigned */
+		detail::MakeInfo(u8"i64.ge_s", { 0x59 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.ge_u", { 0x4f }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* greaterEqualUnsigned */
+		detail::MakeInfo(u8"i64.ge_u", { 0x5a }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.le_s", { 0x4c }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* lessEqualSigned */
+		detail::MakeInfo(u8"i64.le_s", { 0x57 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.le_u", { 0x4d }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* lessEqualUnsigned */
+		detail::MakeInfo(u8"i64.le_u", { 0x58 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i32 }),
+		detail::MakeInfo(u8"i32.div_s", { 0x6d }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* divSigned */
+		detail::MakeInfo(u8"i64.div_s", { 0x7f }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.div_u", { 0x6e }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* divUnsigned */
+		detail::MakeInfo(u8"i64.div_u", { 0x80 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.rem_s", { 0x6f }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* modSigned */
+		detail::MakeInfo(u8"i64.rem_s", { 0x81 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.rem_u", { 0x70 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* modUnsigned */
+		detail::MakeInfo(u8"i64.rem_u", { 0x82 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"f32.convert_i32_s", { 0xb2 }, { wasm::Type::i32 }, { wasm::Type::f32 }), /* convertToF32Signed */
+		detail::MakeInfo(u8"f32.convert_i64_s", { 0xb4 }, { wasm::Type::i64 }, { wasm::Type::f32 }),
+		detail::MakeInfo(u8"f32.convert_i32_u", { 0xb3 }, { wasm::Type::i32 }, { wasm::Type::f32 }), /* convertToF32Unsigned */
+		detail::MakeInfo(u8"f32.convert_i64_u", { 0xb5 }, { wasm::Type::i64 }, { wasm::Type::f32 }),
+		detail::MakeInfo(u8"f64.convert_i32_s", { 0xb7 }, { wasm::Type::i32 }, { wasm::Type::f64 }), /* convertToF64Signed */
+		detail::MakeInfo(u8"f64.convert_i64_s", { 0xb9 }, { wasm::Type::i64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f64.convert_i32_u", { 0xb8 }, { wasm::Type::i32 }, { wasm::Type::f64 }), /* convertToF64Unsigned */
+		detail::MakeInfo(u8"f64.convert_i64_u", { 0xba }, { wasm::Type::i64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"i32.trunc_f32_s", { 0xa8 }, { wasm::Type::f32 }, { wasm::Type::i32 }), /* convertFromF32SignedTrap */
+		detail::MakeInfo(u8"i64.trunc_f32_s", { 0xae }, { wasm::Type::f32 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.trunc_f32_u", { 0xa9 }, { wasm::Type::f32 }, { wasm::Type::i32 }), /* convertFromF32UnsignedTrap */
+		detail::MakeInfo(u8"i64.trunc_f32_u", { 0xaf }, { wasm::Type::f32 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.trunc_f64_s", { 0xaa }, { wasm::Type::f64 }, { wasm::Type::i32 }), /* convertFromF64SignedTrap */
+		detail::MakeInfo(u8"i64.trunc_f64_s", { 0xb0 }, { wasm::Type::f64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.trunc_f64_u", { 0xab }, { wasm::Type::f64 }, { wasm::Type::i32 }), /* convertFromF64UnsignedTrap */
+		detail::MakeInfo(u8"i64.trunc_f64_u", { 0xb1 }, { wasm::Type::f64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.trunc_sat_f32_s", { 0xfc, 0x00 }, { wasm::Type::f32 }, { wasm::Type::i32 }), /* convertFromF32SignedNoTrap */
+		detail::MakeInfo(u8"i64.trunc_sat_f32_s", { 0xfc, 0x04 }, { wasm::Type::f32 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.trunc_sat_f32_u", { 0xfc, 0x01 }, { wasm::Type::f32 }, { wasm::Type::i32 }), /* convertFromF32UnsignedNoTrap */
+		detail::MakeInfo(u8"i64.trunc_sat_f32_u", { 0xfc, 0x05 }, { wasm::Type::f32 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.trunc_sat_f64_s", { 0xfc, 0x02 }, { wasm::Type::f64 }, { wasm::Type::i32 }), /* convertFromF64SignedNoTrap */
+		detail::MakeInfo(u8"i64.trunc_sat_f64_s", { 0xfc, 0x06 }, { wasm::Type::f64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.trunc_sat_f64_u", { 0xfc, 0x03 }, { wasm::Type::f64 }, { wasm::Type::i32 }), /* convertFromF64UnsignedNoTrap */
+		detail::MakeInfo(u8"i64.trunc_sat_f64_u", { 0xfc, 0x07 }, { wasm::Type::f64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"f32.reinterpret_i32", { 0xbe }, { wasm::Type::i32 }, { wasm::Type::f32 }), /* reinterpretAsFloat */
+		detail::MakeInfo(u8"f64.reinterpret_i64", { 0xbf }, { wasm::Type::i64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"i32.and", { 0x71 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitAnd */
+		detail::MakeInfo(u8"i64.and", { 0x83 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.or", { 0x72 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitOr */
+		detail::MakeInfo(u8"i64.or", { 0x84 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.xor", { 0x73 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitXOr */
+		detail::MakeInfo(u8"i64.xor", { 0x85 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.shl", { 0x74 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitShiftLeft */
+		detail::MakeInfo(u8"i64.shl", { 0x86 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.shr_s", { 0x75 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitShiftRightSigned */
+		detail::MakeInfo(u8"i64.shr_s", { 0x87 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.shr_u", { 0x76 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitShiftRightUnsigned */
+		detail::MakeInfo(u8"i64.shr_u", { 0x88 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.rotl", { 0x77 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitRotateLeft */
+		detail::MakeInfo(u8"i64.rotl", { 0x89 }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.rotr", { 0x78 }, { wasm::Type::i32, wasm::Type::i32 }, { wasm::Type::i32 }), /* bitRotateRight */
+		detail::MakeInfo(u8"i64.rotr", { 0x8a }, { wasm::Type::i64, wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.clz", { 0x67 }, { wasm::Type::i32 }, { wasm::Type::i32 }), /* bitLeadingNulls */
+		detail::MakeInfo(u8"i64.clz", { 0x79 }, { wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.ctz", { 0x68 }, { wasm::Type::i32 }, { wasm::Type::i32 }), /* bitTrailingNulls */
+		detail::MakeInfo(u8"i64.ctz", { 0x7a }, { wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"i32.popcnt", { 0x69 }, { wasm::Type::i32 }, { wasm::Type::i32 }), /* bitSetCount */
+		detail::MakeInfo(u8"i64.popcnt", { 0x7b }, { wasm::Type::i64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"f32.div", { 0x95 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::f32 }), /* floatDiv */
+		detail::MakeInfo(u8"f64.div", { 0xa3 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"i32.reinterpret_f32", { 0xbc }, { wasm::Type::f32 }, { wasm::Type::i32 }), /* reinterpretAsInt */
+		detail::MakeInfo(u8"i64.reinterpret_f64", { 0xbd }, { wasm::Type::f64 }, { wasm::Type::i64 }),
+		detail::MakeInfo(u8"f32.min", { 0x96 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::f32 }), /* floatMin */
+		detail::MakeInfo(u8"f64.min", { 0xa4 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.max", { 0x97 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::f32 }), /* floatMax */
+		detail::MakeInfo(u8"f64.max", { 0xa5 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.floor", { 0x8e }, { wasm::Type::f32 }, { wasm::Type::f32 }), /* floatFloor */
+		detail::MakeInfo(u8"f64.floor", { 0x9c }, { wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.nearest", { 0x90 }, { wasm::Type::f32 }, { wasm::Type::f32 }), /* floatRound */
+		detail::MakeInfo(u8"f64.nearest", { 0x9e }, { wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.ceil", { 0x8d }, { wasm::Type::f32 }, { wasm::Type::f32 }), /* floatCeil */
+		detail::MakeInfo(u8"f64.ceil", { 0x9b }, { wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.trunc", { 0x8f }, { wasm::Type::f32 }, { wasm::Type::f32 }), /* floatTruncate */
+		detail::MakeInfo(u8"f64.trunc", { 0x9d }, { wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.abs", { 0x8b }, { wasm::Type::f32 }, { wasm::Type::f32 }), /* floatAbsolute */
+		detail::MakeInfo(u8"f64.abs", { 0x99 }, { wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.neg", { 0x8c }, { wasm::Type::f32 }, { wasm::Type::f32 }), /* floatNegate */
+		detail::MakeInfo(u8"f64.neg", { 0x9a }, { wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.sqrt", { 0x91 }, { wasm::Type::f32 }, { wasm::Type::f32 }), /* floatSquareRoot */
+		detail::MakeInfo(u8"f64.sqrt", { 0x9f }, { wasm::Type::f64 }, { wasm::Type::f64 }),
+		detail::MakeInfo(u8"f32.copysign", { 0x98 }, { wasm::Type::f32, wasm::Type::f32 }, { wasm::Type::f32 }), /* floatCopySign */
+		detail::MakeInfo(u8"f64.copysign", { 0xa6 }, { wasm::Type::f64, wasm::Type::f64 }, { wasm::Type::f64 })
+	};
+
+	static_assert(std::size(detail::SimpleInfo) == size_t(wasm::InstSimple::Type::shrinkFloat) + 1);
+	static_assert(std::size(detail::OperandInfo) == (size_t(wasm::InstOperand::Type::mul) + 1) * 4);
+	static_assert(std::size(detail::WidthInfo) == (size_t(wasm::InstWidth::Type::floatCopySign) + 1) * 2);
+
+	/* fetch the description of the instruction (throws for unknown instruction types) */
+	constexpr const detail::InstInfo& GetInfo(const wasm::InstSimple& inst) {
+		if (size_t(inst.type) >= std::size(detail::SimpleInfo))
+			throw wasm::Exception{ "Unknown wasm::InstSimple type [", size_t(inst.type), "] encountered" };
+		return detail::SimpleInfo[size_t(inst.type)];
+	}
+	constexpr const detail::InstInfo& GetInfo(const wasm::InstOperand& inst) {
+		if (size_t(inst.type) > size_t(wasm::InstOperand::Type::mul))
+			throw wasm::Exception{ "Unknown wasm::InstOperand type [", size_t(inst.type), "] encountered" };
+		if (size_t(inst.operand) > size_t(wasm::OpType::f64))
+			throw wasm::Exception{ "Unknown wasm::OpType type [", size_t(inst.operand), "] encountered" };
+		return detail::OperandInfo[size_t(inst.type) * 4 + size_t(inst.operand)];
+	}
+	constexpr const detail::InstInfo& GetInfo(const wasm::InstWidth& inst) {
+		if (size_t(inst.type) > size_t(wasm::InstWidth::Type::floatCopySign))
+			throw wasm::Exception{ "Unknown wasm::InstWidth type [", size_t(inst.type), "] encountered" };
+		return detail::WidthInfo[size_t(inst.type) * 2 + (inst.width32 ? 0 : 1)];
+	}
+}
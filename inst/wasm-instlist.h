@@ -7,18 +7,28 @@
 namespace wasm::inst {
 	struct Branch {
 		static constexpr wasm::InstBranch Direct(const wasm::Target& target) {
-			return wasm::InstBranch{ wasm::InstBranch::Type::direct, {}, target };
+			return wasm::InstBranch{ wasm::InstBranch::Type::direct, target };
 		}
 
 		/* expected on stack: [condition] */
 		static constexpr wasm::InstBranch If(const wasm::Target& target) {
-			return wasm::InstBranch{ wasm::InstBranch::Type::conditional, {}, target };
+			return wasm::InstBranch{ wasm::InstBranch::Type::conditional, target };
 		}
 
 		/* expected on stack: [index] */
 		static constexpr wasm::InstBranch Table(std::vector<wasm::WTarget> optTarget, const wasm::Target& defTarget) {
+			return wasm::InstBranch{ wasm::InstBranch::Type::table, std::move(optTarget), defTarget };
+		}
+
+		/* expected on stack: [index] (targets are not copied, and must outlive the instruction) */
+		static constexpr wasm::InstBranch TableBorrowed(std::span<const wasm::WTarget> optTarget, const wasm::Target& defTarget) {
 			return wasm::InstBranch{ wasm::InstBranch::Type::table, optTarget, defTarget };
 		}
+
+		/* expected on stack: [index] (relative depths of the targets, which are not copied, and must outlive the instruction) */
+		static constexpr wasm::InstBranch TableDepths(std::span<const uint32_t> optDepths, const wasm::Target& defTarget) {
+			return wasm::InstBranch{ wasm::InstBranch::Type::table, optDepths, defTarget };
+		}
 	};
 
 	struct Call {
@@ -43,7 +53,7 @@ namespace wasm::inst {
 		}
 
 		/* expected on stack: [parameter] [table-index] */
-		static constexpr wasm::InstIndirect Indirect(const wasm::Table& table, std::vector<wasm::Type> params = {}, std::vector<wasm::Type> result = {}) {
+		static constexpr wasm::InstIndirect Indirect(const wasm::Table& table, wasm::TypeList params = {}, wasm::TypeList result = {}) {
 			wasm::Prototype type{};
 			if (table.valid())
 				type = table.module().prototype(params, result);
@@ -51,7 +61,7 @@ namespace wasm::inst {
 		}
 
 		/* expected on stack: [parameter] [table-index] */
-		static constexpr wasm::InstIndirect IndirectTail(const wasm::Table& table, std::vector<wasm::Type> params = {}, std::vector<wasm::Type> result = {}) {
+		static constexpr wasm::InstIndirect IndirectTail(const wasm::Table& table, wasm::TypeList params = {}, wasm::TypeList result = {}) {
 			wasm::Prototype type{};
 			if (table.valid())
 				type = table.module().prototype(params, result);
@@ -304,11 +304,70 @@ namespace wasm {
 		};
 
 	public:
+		/* optional targets of a table, either owned, borrowed from the caller, or as relative depths (borrowed from the caller) */
 		std::vector<wasm::WTarget> list;
+		std::span<const wasm::WTarget> borrowed;
+		std::span<const uint32_t> depths;
 		const wasm::Target& target;
 		Type type = Type::direct;
 
 	public:
-		constexpr InstBranch(Type type, std::vector<wasm::WTarget> list, const wasm::Target& target) : list(list), target{ target }, type{ type } {}
+		constexpr InstBranch(Type type, const wasm::Target& target) : target{ target }, type{ type } {}
+		constexpr InstBranch(Type type, std::vector<wasm::WTarget> list, const wasm::Target& target) : list(std::move(list)), target{ target }, type{ type } {}
+		constexpr InstBranch(Type type, std::span<const wasm::WTarget> borrowed, const wasm::Target& target) : borrowed{ borrowed }, target{ target }, type{ type } {}
+		constexpr InstBranch(Type type, std::span<const uint32_t> depths, const wasm::Target& target) : depths{ depths }, target{ target }, type{ type } {}
+
+	public:
+		/* optional targets of a table, which are not given as relative depths */
+		constexpr std::span<const wasm::WTarget> targets() const {
+			return (list.empty() ? borrowed : std::span<const wasm::WTarget>{ list });
+		}
 	};
+
+	/* description of any instruction, which can be passed to a sink-interface, used to submit
+	*	batches of instructions (parameter accesses must be submitted as locals via wasm::Sink::param) */
+	using InstAny = std::variant<wasm::InstSimple, wasm::InstConst, wasm::InstOperand, wasm::InstWidth, wasm::InstMemory,
+		wasm::InstTable, wasm::InstLocal, wasm::InstGlobal, wasm::InstFunction, wasm::InstIndirect, wasm::InstBranch>;
+
+	namespace detail {
+		/* pass the actual instruction to the visitor (switch instead of std::visit to allow the visitor to be inlined) */
+		template <class Visitor>
+		constexpr void VisitInst(const wasm::InstAny& inst, Visitor&& visitor) {
+			switch (inst.index()) {
+			case 0:
+				visitor(*std::get_if<0>(&inst));
+				break;
+			case 1:
+				visitor(*std::get_if<1>(&inst));
+				break;
+			case 2:
+				visitor(*std::get_if<2>(&inst));
+				break;
+			case 3:
+				visitor(*std::get_if<3>(&inst));
+				break;
+			case 4:
+				visitor(*std::get_if<4>(&inst));
+				break;
+			case 5:
+				visitor(*std::get_if<5>(&inst));
+				break;
+			case 6:
+				visitor(*std::get_if<6>(&inst));
+				break;
+			case 7:
+				visitor(*std::get_if<7>(&inst));
+				break;
+			case 8:
+				visitor(*std::get_if<8>(&inst));
+				break;
+			case 9:
+				visitor(*std::get_if<9>(&inst));
+				break;
+			case 10:
+				visitor(*std::get_if<10>(&inst));
+				break;
+			}
+		}
+	}
 }
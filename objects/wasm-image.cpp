@@ -0,0 +1,181 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "wasm-image.h"
+
+#include <cstring>
+#include <algorithm>
+#include <bit>
+
+wasm::MemoryImage::MemoryImage(const wasm::Memory& memory, uint32_t zeroThreshold) : pMemory{ memory }, pZeroThreshold{ zeroThreshold } {
+	if (!memory.valid())
+		throw wasm::Exception{ "Memory is required to be constructed to create an image of it" };
+
+	/* register the image with the module, which writes it out, should it still be open once the module is closed */
+	wasm::Module& module = pMemory.module();
+	std::unique_lock<std::recursive_mutex> _lock = module.fLock();
+	module.fCheck();
+	module.pImages.push_back(this);
+}
+wasm::MemoryImage::MemoryImage(wasm::MemoryImage&& image) noexcept : pRanges{ std::move(image.pRanges) }, pMemory{ image.pMemory }, pZeroThreshold{ image.pZeroThreshold }, pClosed{ image.pClosed } {
+	image.pClosed = true;
+	if (pClosed)
+		return;
+
+	/* take over the registration of the moved image */
+	wasm::Module& module = pMemory.module();
+	std::unique_lock<std::recursive_mutex> _lock = module.fLock();
+	std::replace(module.pImages.begin(), module.pImages.end(), &image, this);
+}
+wasm::MemoryImage::~MemoryImage() {
+	try {
+		close();
+	}
+	catch (const wasm::Exception& e) {
+		/* defer the exception to the module */
+		wasm::Module& module = pMemory.module();
+		std::unique_lock<std::recursive_mutex> _lock = module.fLock();
+		module.fDeferredException(e);
+	}
+
+	/* ensure that the module does not reference the destroyed image anymore (if the module rejected the close) */
+	if (!pClosed) {
+		wasm::Module& module = pMemory.module();
+		std::unique_lock<std::recursive_mutex> _lock = module.fLock();
+		module.pImages.erase(std::find(module.pImages.begin(), module.pImages.end(), this));
+	}
+}
+
+void wasm::MemoryImage::fFlush(uint32_t address, const uint8_t* data, size_t count, bool exclusive) {
+	/* memories, which may already contain other data, must be written as-is, as the zeros might overwrite the data */
+	if (!exclusive) {
+		pMemory.module().fData(pMemory, wasm::Value::MakeU32(address), data, uint32_t(count), false);
+		return;
+	}
+
+	/* write all non-zero chunks out, which are separated by zero-runs longer than the threshold (leading and trailing zeros are dropped entirely) */
+	size_t begin = 0, end = 0;
+	while (begin < count && data[begin] == 0)
+		++begin;
+	while (begin < count) {
+		/* find the end of the next chunk of data, which ends at a long enough zero-run */
+		size_t zeros = 0;
+		for (end = begin; end < count && zeros <= pZeroThreshold; ++end)
+			zeros = (data[end] == 0 ? zeros + 1 : 0);
+		end -= zeros;
+
+		pMemory.module().fData(pMemory, wasm::Value::MakeU32(uint32_t(address + begin)), data + begin, uint32_t(end - begin), false);
+
+		/* skip the zero-run to the next chunk */
+		for (begin = end; begin < count && data[begin] == 0; ++begin);
+	}
+}
+void wasm::MemoryImage::fWrite(uint32_t address, uint64_t value, size_t size) {
+	/* encode the value explicitly as little-endian, as expected by wasm, independent of the host byte-order */
+	uint8_t bytes[sizeof(uint64_t)] = { 0 };
+	for (size_t i = 0; i < size; ++i)
+		bytes[i] = uint8_t(value >> (8 * i));
+	MemoryImage::write(address, bytes, size);
+}
+void wasm::MemoryImage::fClose() {
+	if (pClosed)
+		return;
+	pClosed = true;
+
+	/* unregister the image from the module (the module is already locked) */
+	wasm::Module& module = pMemory.module();
+	module.pImages.erase(std::find(module.pImages.begin(), module.pImages.end(), this));
+
+	/* check if the image is the only source of data of the memory, in which case all bytes not written by the image are known to be
+	*	zero (imported memories might be initialized externally, and all other data are written before the segments of the image) */
+	bool exclusive = (!pMemory.imported() && !module.pMemory.list[pMemory.index()].written);
+
+	/* write all ranges out as data-segments and release them (for exclusive
+	*	images, ranges separated by short gaps are combined, as the gaps are known to be zero) */
+	for (auto it = pRanges.begin(); it != pRanges.end();) {
+		uint32_t address = it->first;
+		std::vector<uint8_t> data = std::move(it->second);
+		for (++it; it != pRanges.end() && exclusive; ++it) {
+			if (it->first - (uint64_t(address) + data.size()) > pZeroThreshold)
+				break;
+			data.resize(it->first - address);
+			data.insert(data.end(), it->second.begin(), it->second.end());
+		}
+		fFlush(address, data.data(), data.size(), exclusive);
+	}
+	pRanges.clear();
+}
+
+void wasm::MemoryImage::write(uint32_t address, const uint8_t* data, size_t count) {
+	if (pClosed)
+		throw wasm::Exception{ "Cannot write to the closed memory image of memory [", pMemory.toString(), ']' };
+	if (count == 0)
+		return;
+	if (uint64_t(address) + count > (uint64_t(1) << 32))
+		throw wasm::Exception{ "Write to memory image of memory [", pMemory.toString(), "] exceeds the 32-bit address space" };
+	uint64_t stop = uint64_t(address) + count;
+
+	/* find the first range, which overlaps or is adjacent to the new write */
+	auto it = pRanges.upper_bound(address);
+	if (it != pRanges.begin()) {
+		auto prev = std::prev(it);
+		if (prev->first + uint64_t(prev->second.size()) >= address)
+			it = prev;
+	}
+
+	/* check if the data do not touch any other range and can just be added */
+	if (it == pRanges.end() || it->first > stop) {
+		pRanges.emplace_hint(it, address, std::vector<uint8_t>{ data, data + count });
+		return;
+	}
+
+	/* compute the bounds of the merged range (all ranges starting up to the end of the write will be merged) */
+	uint32_t start = std::min<uint32_t>(it->first, address);
+	auto last = (stop > std::numeric_limits<uint32_t>::max() ? pRanges.end() : pRanges.upper_bound(uint32_t(stop)));
+	uint64_t merged = std::max<uint64_t>(stop, std::prev(last)->first + uint64_t(std::prev(last)->second.size()));
+
+	/* reuse the buffer of the first range, if it starts at the merged range, and copy the remaining ranges into it */
+	std::vector<uint8_t> buffer;
+	if (it->first == start) {
+		buffer = std::move(it->second);
+		++it;
+	}
+	buffer.resize(size_t(merged - start));
+	for (; it != last; ++it)
+		std::memcpy(buffer.data() + (it->first - start), it->second.data(), it->second.size());
+
+	/* write the new data on top and replace the merged ranges */
+	std::memcpy(buffer.data() + (address - start), data, count);
+	it = pRanges.erase(pRanges.lower_bound(start), last);
+	pRanges.emplace_hint(it, start, std::move(buffer));
+}
+void wasm::MemoryImage::write(uint32_t address, std::span<const uint8_t> data) {
+	MemoryImage::write(address, data.data(), data.size());
+}
+void wasm::MemoryImage::writeU8(uint32_t address, uint8_t value) {
+	MemoryImage::write(address, &value, sizeof(value));
+}
+void wasm::MemoryImage::writeU16(uint32_t address, uint16_t value) {
+	MemoryImage::fWrite(address, value, sizeof(value));
+}
+void wasm::MemoryImage::writeU32(uint32_t address, uint32_t value) {
+	MemoryImage::fWrite(address, value, sizeof(value));
+}
+void wasm::MemoryImage::writeU64(uint32_t address, uint64_t value) {
+	MemoryImage::fWrite(address, value, sizeof(value));
+}
+void wasm::MemoryImage::writeF32(uint32_t address, float value) {
+	MemoryImage::fWrite(address, std::bit_cast<uint32_t>(value), sizeof(value));
+}
+void wasm::MemoryImage::writeF64(uint32_t address, double value) {
+	MemoryImage::fWrite(address, std::bit_cast<uint64_t>(value), sizeof(value));
+}
+void wasm::MemoryImage::close() {
+	if (pClosed)
+		return;
+
+	/* the module must still be open, as it would otherwise already have written the image out */
+	wasm::Module& module = pMemory.module();
+	std::unique_lock<std::recursive_mutex> _lock = module.fLock();
+	module.fCheck();
+	fClose();
+}
@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "wasm-module.h"
+
+#include <map>
+
+namespace wasm {
+	/* sparse image of the initial content of a wasm-memory, which collects scattered writes, merges overlapping and adjacent
+	*	ranges, and on close writes the minimal set of data-segments out to the module of the memory (later writes take precedence)
+	*	Note: bytes not written by the image are only assumed to be zero, if the memory is not imported and no other data have been written
+	*		to it before the image is closed (only then are short gaps between ranges filled with zeros, and zero-runs longer than the threshold
+	*		dropped; otherwise all ranges, including their zeros, are written as-is, as the segments of the image are written last)
+	*	Note: open images are registered with the module, which writes them out once the module itself is closed */
+	class MemoryImage {
+		friend class wasm::Module;
+	private:
+		std::map<uint32_t, std::vector<uint8_t>> pRanges;
+		wasm::Memory pMemory;
+		uint32_t pZeroThreshold = 0;
+		bool pClosed = false;
+
+	public:
+		MemoryImage(const wasm::Memory& memory, uint32_t zeroThreshold = 16);
+		MemoryImage(wasm::MemoryImage&& image) noexcept;
+		MemoryImage(const wasm::MemoryImage&) = delete;
+		~MemoryImage();
+
+	private:
+		void fFlush(uint32_t address, const uint8_t* data, size_t count, bool exclusive);
+		void fWrite(uint32_t address, uint64_t value, size_t size);
+		void fClose();
+
+	public:
+		void write(uint32_t address, const uint8_t* data, size_t count);
+		void write(uint32_t address, std::span<const uint8_t> data);
+		void writeU8(uint32_t address, uint8_t value);
+		void writeU16(uint32_t address, uint16_t value);
+		void writeU32(uint32_t address, uint32_t value);
+		void writeU64(uint32_t address, uint64_t value);
+		void writeF32(uint32_t address, float value);
+		void writeF64(uint32_t address, double value);
+		void close();
+	};
+}
@@ -11,6 +11,7 @@ namespace wasm {
 			wasm::Limit limit;
 			std::u8string_view id;
 			bool exported = false;
+			bool written = false;
 		};
 	}
 
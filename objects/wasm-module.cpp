@@ -2,8 +2,11 @@
 /* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
 #include "wasm-module.h"
 #include "../sink/wasm-sink.h"
+#include "../sink/wasm-recorder.h"
+#include "wasm-image.h"
 
-wasm::Module::Module(wasm::ModuleInterface* interface) : pInterface{ interface } {}
+wasm::Module::Module(wasm::ModuleInterface* interface, const wasm::ModuleOptions& options) : pInterface{ interface }, pOptions{ options } {}
+wasm::Module::~Module() = default;
 
 wasm::Prototype wasm::Module::fPrototype(std::u8string_view id, std::vector<wasm::Param> params, std::vector<wasm::Type> result) {
 	/* validate the id and the parameter */
@@ -21,6 +24,9 @@ wasm::Prototype wasm::Module::fPrototype(std::u8string_view id, std::vector<wasm
 
 	/* setup the prototype-state */
 	detail::PrototypeState state;
+	for (const wasm::Param& param : params)
+		state.signature.push_back(param.type);
+	state.signature.insert(state.signature.end(), result.begin(), result.end());
 	state.parameter = std::move(params);
 	state.result = std::move(result);
 
@@ -34,38 +40,40 @@ wasm::Prototype wasm::Module::fPrototype(std::u8string_view id, std::vector<wasm
 	pInterface->addPrototype(prototype);
 	return prototype;
 }
-wasm::Prototype wasm::Module::fPrototype(std::vector<wasm::Type> params, std::vector<wasm::Type> result) {
-	/* check if its the null-type */
-	if (params.size() == 0 && result.size() == 0 && pNullPrototype.valid())
-		return pNullPrototype;
-
-	/* setup the type-key */
-	PrototypeKey key{};
-	key.list.insert(key.list.end(), params.begin(), params.end());
-	key.list.insert(key.list.end(), result.begin(), result.end());
-	key.params = params.size();
-
-	/* lookup the type in the map of anonymous-types */
-	auto it = pAnonTypes.find(key);
-	if (it != pAnonTypes.end())
-		return wasm::Prototype{ *this, it->second };
+wasm::Prototype wasm::Module::fPrototype(std::span<const wasm::Type> params, std::span<const wasm::Type> result) {
+	/* check if its the null-type or a single-result type (the common block-types) */
+	if (params.empty() && result.size() <= 1) {
+		const wasm::Prototype& cached = (result.empty() ? pNullPrototype : pResultPrototype[size_t(result[0])]);
+		if (cached.valid())
+			return cached;
+	}
+	else {
+		/* lookup the type in the map of anonymous-types (the key only references the types) */
+		auto it = pAnonTypes.find(PrototypeKey{ params, result });
+		if (it != pAnonTypes.end())
+			return wasm::Prototype{ *this, it->second };
+	}
 
 	/* setup the prototype-state */
 	detail::PrototypeState state;
 	for (wasm::Type param : params)
 		state.parameter.emplace_back(param);
-	state.result = std::move(result);
+	state.result.assign(result.begin(), result.end());
+	state.signature.reserve(params.size() + result.size());
+	state.signature.assign(params.begin(), params.end());
+	state.signature.insert(state.signature.end(), result.begin(), result.end());
 
 	/* allocate the next id and register the next prototype */
 	pPrototype.list.push_back(std::move(state));
 	wasm::Prototype prototype{ *this, uint32_t(pPrototype.list.size() - 1) };
 
-	/* check if this is the null-type and otherwise insert it into the map */
-	if (pPrototype.list.back().parameter.size() == 0 && pPrototype.list.back().result.size() == 0)
-		pNullPrototype = prototype;
+	/* check if this is a cached type and otherwise insert it into the map (keyed by its own
+	*	signature, which remains valid, as prototypes are never relocated or modified) */
+	if (params.empty() && result.size() <= 1)
+		(result.empty() ? pNullPrototype : pResultPrototype[size_t(result[0])]) = prototype;
 	else {
-		std::pair<PrototypeKey, uint32_t> value{ std::move(key), prototype.index() };
-		pAnonTypes.insert(std::move(value));
+		std::span<const wasm::Type> signature = pPrototype.list.back().signature;
+		pAnonTypes.insert({ PrototypeKey{ signature.first(params.size()), signature.subspan(params.size()) }, prototype.index() });
 	}
 
 	/* notify the interface about the added prototype */
@@ -105,7 +113,7 @@ wasm::Function wasm::Module::fFunction(std::u8string_view id, const wasm::Protot
 	pInterface->addFunction(function);
 	return function;
 }
-void wasm::Module::fData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) {
+void wasm::Module::fData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) {
 	/* validate the memory */
 	if (!memory.valid())
 		throw wasm::Exception{ "Memory is required to be constructed to write data to it" };
@@ -126,8 +134,10 @@ void wasm::Module::fData(const wasm::Memory& memory, const wasm::Value& offset,
 			throw wasm::Exception{ "Imported offset to write to memory [", memory.toString(), "] must be an immutable imported i32" };
 	}
 
-	/* pass the validated data to the interface */
-	pInterface->writeData(memory, offset, data, count);
+	/* pass the validated data to the interface (and mark the memory as containing data, which memory-images cannot assume to be zero) */
+	pInterface->writeData(memory, offset, data, count, borrowed);
+	if (count > 0)
+		pMemory.list[memory.index()].written = true;
 }
 void wasm::Module::fElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) {
 	/* validate the memory */
@@ -248,6 +258,10 @@ void wasm::Module::fClose() {
 			pFunction.list[i].sink->fClose();
 	}
 
+	/* write all still open images out (closing an image unregisters it from the module) */
+	while (!pImages.empty())
+		pImages.front()->fClose();
+
 	/* mark the module as closed */
 	pInterface->close(*this);
 }
@@ -255,16 +269,25 @@ void wasm::Module::fDeferredException(const wasm::Exception& error) {
 	if (pException.empty())
 		pException = error.what();
 }
+std::unique_lock<std::recursive_mutex> wasm::Module::fLock() const {
+	/* only serialize the module-state if sinks are allowed to be filled concurrently */
+	if (!pOptions.concurrent)
+		return {};
+	return std::unique_lock<std::recursive_mutex>{ pMutex };
+}
 
-wasm::Prototype wasm::Module::prototype(std::vector<wasm::Type> params, std::vector<wasm::Type> result) {
+wasm::Prototype wasm::Module::prototype(wasm::TypeList params, wasm::TypeList result) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 	return fPrototype(params, result);
 }
 wasm::Prototype wasm::Module::prototype(std::u8string_view id, std::vector<wasm::Param> params, std::vector<wasm::Type> result) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 	return fPrototype(id, params, result);
 }
 wasm::Memory wasm::Module::memory(std::u8string_view id, const wasm::Limit& limit, const wasm::Exchange& exchange) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 
 	/* validate the import/export parameter */
@@ -300,6 +323,7 @@ wasm::Memory wasm::Module::memory(std::u8string_view id, const wasm::Limit& limi
 	return memory;
 }
 wasm::Table wasm::Module::table(std::u8string_view id, bool functions, const wasm::Limit& limit, const wasm::Exchange& exchange) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 
 	/* validate the import/export parameter */
@@ -335,6 +359,7 @@ wasm::Table wasm::Module::table(std::u8string_view id, bool functions, const was
 	return table;
 }
 wasm::Global wasm::Module::global(std::u8string_view id, wasm::Type type, bool mutating, const wasm::Exchange& exchange) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 
 	/* validate the import/export parameter */
@@ -366,14 +391,17 @@ wasm::Global wasm::Module::global(std::u8string_view id, wasm::Type type, bool m
 	return global;
 }
 wasm::Function wasm::Module::function(std::u8string_view id, const wasm::Prototype& prototype, const wasm::Exchange& exchange) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 	return fFunction(id, prototype, exchange);
 }
-wasm::Function wasm::Module::function(std::u8string_view id, std::vector<wasm::Type> params, std::vector<wasm::Type> result, const wasm::Exchange& exchange) {
+wasm::Function wasm::Module::function(std::u8string_view id, wasm::TypeList params, wasm::TypeList result, const wasm::Exchange& exchange) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 	return fFunction(id, fPrototype(params, result), exchange);
 }
 void wasm::Module::startup(const wasm::Function& function) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 
 	/* validate the function */
@@ -390,7 +418,16 @@ void wasm::Module::startup(const wasm::Function& function) {
 	pHasStartup = true;
 	pInterface->setStartup(function);
 }
+void wasm::Module::inlining(uint32_t size, uint32_t depth) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
+	fCheck();
+
+	/* configure the budgets for all sinks created from now on (a size of zero disables the inlining) */
+	pInlineSize = size;
+	pInlineDepth = depth;
+}
 void wasm::Module::limit(const wasm::Memory& memory, const wasm::Limit& limit) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 
 	/* validate the memory */
@@ -412,6 +449,7 @@ void wasm::Module::limit(const wasm::Memory& memory, const wasm::Limit& limit) {
 	pInterface->setMemoryLimit(memory);
 }
 void wasm::Module::limit(const wasm::Table& table, const wasm::Limit& limit) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 
 	/* validate the table */
@@ -433,6 +471,7 @@ void wasm::Module::limit(const wasm::Table& table, const wasm::Limit& limit) {
 	pInterface->setTableLimit(table);
 }
 void wasm::Module::value(const wasm::Global& global, const wasm::Value& value) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 
 	/* validate the global */
@@ -490,22 +529,32 @@ void wasm::Module::value(const wasm::Global& global, const wasm::Value& value) {
 	pInterface->setValue(global, value);
 }
 void wasm::Module::data(const wasm::Memory& memory, const wasm::Value& offset, const std::vector<uint8_t>& data) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
-	fData(memory, offset, data.data(), uint32_t(data.size()));
+	fData(memory, offset, data.data(), uint32_t(data.size()), false);
 }
 void wasm::Module::data(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, size_t count) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
+	fCheck();
+	fData(memory, offset, data, uint32_t(count), false);
+}
+void wasm::Module::data(const wasm::Memory& memory, const wasm::Value& offset, std::span<const uint8_t> data, bool borrowed) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
-	fData(memory, offset, data, uint32_t(count));
+	fData(memory, offset, data.data(), uint32_t(data.size()), borrowed);
 }
 void wasm::Module::elements(const wasm::Table& table, const wasm::Value& offset, const std::vector<wasm::Value>& values) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 	fElements(table, offset, values.data(), uint32_t(values.size()));
 }
 void wasm::Module::elements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, size_t count) {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fCheck();
 	fElements(table, offset, values, uint32_t(count));
 }
 void wasm::Module::close() {
+	std::unique_lock<std::recursive_mutex> _lock = fLock();
 	fClose();
 }
 
@@ -9,6 +9,9 @@
 #include "wasm-global.h"
 #include "wasm-function.h"
 #include "wasm-value.h"
+#include "wasm-stable.h"
+
+#include <mutex>
 
 namespace wasm {
 	/* module interface used to define a wasm-module */
@@ -25,7 +28,9 @@ namespace wasm {
 		virtual void setTableLimit(const wasm::Table& table) = 0;
 		virtual void setStartup(const wasm::Function& function) = 0;
 		virtual void setValue(const wasm::Global& global, const wasm::Value& value) = 0;
-		virtual void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) = 0;
+		/* borrowed data is guaranteed by the caller to remain valid until the writer has produced its final output, which
+		*	can be after the module has been closed (i.e. the binary-writer only references it until its output is consumed) */
+		virtual void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) = 0;
 		virtual void writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) = 0;
 	};
 
@@ -33,10 +38,11 @@ namespace wasm {
 	class Module {
 		template <class> friend class detail::ModuleMember;
 		friend class wasm::Sink;
+		friend class wasm::MemoryImage;
 	private:
 		template <class Type>
 		struct Types {
-			std::vector<Type> list;
+			detail::StableList<Type> list;
 			std::unordered_set<std::u8string> ids;
 		};
 		struct PrototypeList {
@@ -89,18 +95,22 @@ namespace wasm {
 				return wasm::Function{ *_this, index };
 			}
 		};
+		/* keys only reference the types (stored keys reference the signature of the interned prototype) */
 		struct PrototypeKey {
-			std::vector<wasm::Type> list;
-			size_t params = 0;
+			std::span<const wasm::Type> params;
+			std::span<const wasm::Type> result;
 		};
 		struct PrototypeKeyOps {
+			static std::u8string_view fBytes(std::span<const wasm::Type> types) {
+				return std::u8string_view{ reinterpret_cast<const char8_t*>(types.data()), sizeof(wasm::Type) * types.size() };
+			}
 			std::size_t operator()(const Module::PrototypeKey& k) const {
-				std::size_t h0 = std::hash<size_t>{}(k.params);
-				std::size_t h1 = std::hash<std::u8string_view>{}(std::u8string_view{ reinterpret_cast<const char8_t*>(k.list.data()), sizeof(wasm::Type) * k.list.size() });
+				std::size_t h0 = std::hash<std::u8string_view>{}(PrototypeKeyOps::fBytes(k.params));
+				std::size_t h1 = std::hash<std::u8string_view>{}(PrototypeKeyOps::fBytes(k.result));
 				return h0 ^ (h1 << 1);
 			}
 			bool operator()(const Module::PrototypeKey& l, const Module::PrototypeKey& r) const {
-				return (l.params == r.params && l.list == r.list);
+				return (PrototypeKeyOps::fBytes(l.params) == PrototypeKeyOps::fBytes(r.params) && PrototypeKeyOps::fBytes(l.result) == PrototypeKeyOps::fBytes(r.result));
 			}
 		};
 
@@ -113,41 +123,54 @@ namespace wasm {
 		Types<detail::FunctionState> pFunction;
 		wasm::ModuleInterface* pInterface = 0;
 		mutable std::string pException;
+		mutable std::recursive_mutex pMutex;
 		wasm::Prototype pNullPrototype;
+		wasm::Prototype pResultPrototype[size_t(wasm::Type::refFunction) + 1];
+		std::vector<detail::SinkCache> pSinkCache;
+		std::vector<wasm::MemoryImage*> pImages;
+		std::unordered_map<uint32_t, std::unique_ptr<detail::SinkRecorder>> pInlined;
+		uint32_t pInlineSize = 0;
+		uint32_t pInlineDepth = 0;
+		wasm::ModuleOptions pOptions;
 		bool pImportsClosed = false;
 		bool pClosed = false;
 		bool pHasStartup = false;
 
 	public:
-		Module(wasm::ModuleInterface* interface);
+		Module(wasm::ModuleInterface* interface, const wasm::ModuleOptions& options = {});
 		Module() = delete;
 		Module(wasm::Module&&) = delete;
 		Module(const wasm::Module&) = delete;
+		~Module();
 
 	private:
 		wasm::Prototype fPrototype(std::u8string_view id, std::vector<wasm::Param> params, std::vector<wasm::Type> result);
-		wasm::Prototype fPrototype(std::vector<wasm::Type> params, std::vector<wasm::Type> result);
+		wasm::Prototype fPrototype(std::span<const wasm::Type> params, std::span<const wasm::Type> result);
 		wasm::Function fFunction(std::u8string_view id, const wasm::Prototype& prototype, const wasm::Exchange& exchange);
-		void fData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count);
+		void fData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed);
 		void fElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count);
 		void fCheck() const;
 		void fClose();
 		void fDeferredException(const wasm::Exception& error);
+		std::unique_lock<std::recursive_mutex> fLock() const;
 
 	public:
-		wasm::Prototype prototype(std::vector<wasm::Type> params, std::vector<wasm::Type> result);
+		wasm::Prototype prototype(wasm::TypeList params, wasm::TypeList result);
 		wasm::Prototype prototype(std::u8string_view id, std::vector<wasm::Param> params, std::vector<wasm::Type> result);
 		wasm::Memory memory(std::u8string_view id, const wasm::Limit& limit = {}, const wasm::Exchange& exchange = {});
 		wasm::Table table(std::u8string_view id, bool functions, const wasm::Limit& limit = {}, const wasm::Exchange& exchange = {});
 		wasm::Global global(std::u8string_view id, wasm::Type type, bool mutating, const wasm::Exchange& exchange = {});
 		wasm::Function function(std::u8string_view id, const wasm::Prototype& prototype, const wasm::Exchange& exchange = {});
-		wasm::Function function(std::u8string_view id, std::vector<wasm::Type> params, std::vector<wasm::Type> result, const wasm::Exchange& exchange = {});
+		wasm::Function function(std::u8string_view id, wasm::TypeList params, wasm::TypeList result, const wasm::Exchange& exchange = {});
 		void startup(const wasm::Function& function);
+		void inlining(uint32_t size, uint32_t depth);
 		void limit(const wasm::Memory& memory, const wasm::Limit& limit);
 		void limit(const wasm::Table& table, const wasm::Limit& limit);
 		void value(const wasm::Global& global, const wasm::Value& value);
 		void data(const wasm::Memory& memory, const wasm::Value& offset, const std::vector<uint8_t>& data);
 		void data(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, size_t count);
+		/* borrowed data must remain valid until the writer has produced its final output (see wasm::ModuleInterface::writeData) */
+		void data(const wasm::Memory& memory, const wasm::Value& offset, std::span<const uint8_t> data, bool borrowed);
 		void elements(const wasm::Table& table, const wasm::Value& offset, const std::vector<wasm::Value>& values);
 		void elements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, size_t count);
 		void close();
@@ -183,6 +206,15 @@ namespace wasm {
 	constexpr const std::vector<wasm::Type>& wasm::Prototype::result() const {
 		return fGet()->result;
 	}
+	constexpr std::span<const wasm::Type> wasm::Prototype::signature() const {
+		return fGet()->signature;
+	}
+	constexpr std::span<const wasm::Type> wasm::Prototype::parameterTypes() const {
+		return std::span<const wasm::Type>{ fGet()->signature }.first(fGet()->parameter.size());
+	}
+	constexpr std::span<const wasm::Type> wasm::Prototype::resultTypes() const {
+		return std::span<const wasm::Type>{ fGet()->signature }.subspan(fGet()->parameter.size());
+	}
 	constexpr bool wasm::Memory::imported() const {
 		return !fGet()->importModule.empty();
 	}
@@ -9,6 +9,7 @@ namespace wasm {
 		struct PrototypeState {
 			std::vector<wasm::Param> parameter;
 			std::vector<wasm::Type> result;
+			std::vector<wasm::Type> signature;
 			std::u8string_view id;
 		};
 	}
@@ -25,5 +26,10 @@ namespace wasm {
 	public:
 		constexpr const std::vector<wasm::Param>& parameter() const;
 		constexpr const std::vector<wasm::Type>& result() const;
+
+		/* contiguous types of the parameters, followed by the types of the results */
+		constexpr std::span<const wasm::Type> signature() const;
+		constexpr std::span<const wasm::Type> parameterTypes() const;
+		constexpr std::span<const wasm::Type> resultTypes() const;
 	};
 }
@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "../wasm-common.h"
+
+#include <atomic>
+#include <bit>
+#include <memory>
+
+namespace wasm::detail {
+	/* append-only list, which stores its elements in chunks of doubling size, which are never relocated
+	*	(elements can therefore be read without synchronization, while another thread appends further elements) */
+	template <class Type>
+	class StableList {
+	private:
+		static constexpr size_t BaseBits = 4;
+		static constexpr size_t ChunkCount = sizeof(size_t) * 8 - StableList::BaseBits;
+
+	private:
+		std::unique_ptr<Type[]> pChunks[StableList::ChunkCount];
+		std::atomic<size_t> pSize = 0;
+
+	public:
+		StableList() = default;
+		StableList(detail::StableList<Type>&&) = delete;
+		StableList(const detail::StableList<Type>&) = delete;
+
+	private:
+		static constexpr size_t fChunk(size_t index) {
+			return size_t(std::bit_width(index + (size_t(1) << StableList::BaseBits))) - 1 - StableList::BaseBits;
+		}
+		static constexpr size_t fOffset(size_t index, size_t chunk) {
+			return index + (size_t(1) << StableList::BaseBits) - (size_t(1) << (chunk + StableList::BaseBits));
+		}
+
+	public:
+		constexpr size_t size() const {
+			return pSize.load(std::memory_order::acquire);
+		}
+		constexpr Type& operator[](size_t index) {
+			size_t chunk = StableList::fChunk(index);
+			return pChunks[chunk][StableList::fOffset(index, chunk)];
+		}
+		constexpr const Type& operator[](size_t index) const {
+			size_t chunk = StableList::fChunk(index);
+			return pChunks[chunk][StableList::fOffset(index, chunk)];
+		}
+		constexpr Type& back() {
+			return (*this)[size() - 1];
+		}
+		void push_back(Type&& value) {
+			size_t index = pSize.load(std::memory_order::relaxed);
+			size_t chunk = StableList::fChunk(index), offset = StableList::fOffset(index, chunk);
+
+			/* allocate the next chunk once the previous chunks have been filled */
+			if (offset == 0)
+				pChunks[chunk] = std::make_unique<Type[]>(size_t(1) << (chunk + StableList::BaseBits));
+			pChunks[chunk][offset] = std::move(value);
+			pSize.store(index + 1, std::memory_order::release);
+		}
+	};
+}
@@ -0,0 +1,499 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "wasm-recorder.h"
+#include "../objects/wasm-module.h"
+
+void wasm::detail::SinkRecorder::fGraph(uint32_t parameter, std::vector<Block>& blocks, std::vector<Access>& accesses) const {
+	std::vector<Frame> frames;
+	std::vector<uint32_t> order;
+	uint32_t current = 0, activated = 0;
+
+	/* helpers to create new blocks, and to continue the recording of accesses in a block */
+	auto create = [&]() -> uint32_t {
+		blocks.emplace_back();
+		order.push_back(0);
+		return uint32_t(blocks.size() - 1);
+		};
+	auto activate = [&](uint32_t block) {
+		order[block] = activated++;
+		blocks[block].first = accesses.size();
+		blocks[block].last = accesses.size();
+		current = block;
+		};
+	auto edge = [&](uint32_t from, uint32_t to) {
+		blocks[from].next.push_back(to);
+		};
+	auto target = [&](uint32_t depth) -> uint32_t {
+		const Frame& frame = frames[frames.size() - 1 - depth];
+		return (frame.type == wasm::ScopeType::loop ? frame.header : frame.end);
+		};
+	activate(create());
+
+	/* construct the control-flow graph of the structured control-flow (the last block exits the function) */
+	for (const Event& event : pEvents) {
+		if (const Scope* scope = std::get_if<Scope>(&event); scope != 0) {
+			Frame frame;
+			frame.type = scope->type;
+			if (scope->type == wasm::ScopeType::loop) {
+				frame.header = create();
+				edge(current, frame.header);
+				activate(frame.header);
+			}
+			else if (scope->type == wasm::ScopeType::conditional) {
+				frame.condition = current;
+				uint32_t then = create();
+				edge(current, then);
+				activate(then);
+			}
+			frame.end = create();
+			frames.push_back(frame);
+		}
+		else if (std::holds_alternative<Toggle>(event)) {
+			Frame& frame = frames.back();
+			edge(current, frame.end);
+			uint32_t otherwise = create();
+			edge(frame.condition, otherwise);
+			activate(otherwise);
+			frame.otherwise = true;
+		}
+		else if (std::holds_alternative<Pop>(event)) {
+			Frame& frame = frames.back();
+			edge(current, frame.end);
+			if (frame.type == wasm::ScopeType::conditional && !frame.otherwise)
+				edge(frame.condition, frame.end);
+			activate(frame.end);
+			frames.pop_back();
+		}
+		else if (const Branch* branch = std::get_if<Branch>(&event); branch != 0) {
+			edge(current, target(branch->depth));
+			for (uint32_t depth : branch->table)
+				edge(current, target(depth));
+
+			/* only the conditional branch falls through to the next instruction */
+			uint32_t next = create();
+			if (branch->type == wasm::InstBranch::Type::conditional)
+				edge(current, next);
+			activate(next);
+		}
+		else if (const wasm::InstSimple* inst = std::get_if<wasm::InstSimple>(&event); inst != 0) {
+			if (inst->type == wasm::InstSimple::Type::ret || inst->type == wasm::InstSimple::Type::unreachable)
+				activate(create());
+		}
+		else if (const Local* inst = std::get_if<Local>(&event); inst != 0) {
+			if (inst->index < parameter)
+				continue;
+			accesses.push_back({ inst->index - parameter, inst->type != wasm::InstLocal::Type::get });
+			blocks[current].last = accesses.size();
+		}
+	}
+
+	/* renumber the blocks in the order of their activation (i.e. the order of the instructions, as the end of each
+	*	scope is created before its body), which lets the reversed liveness-iteration converge within few passes */
+	std::vector<Block> ordered(blocks.size());
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		for (uint32_t& next : blocks[i].next)
+			next = order[next];
+		ordered[order[i]] = std::move(blocks[i]);
+	}
+	blocks.swap(ordered);
+}
+std::vector<uint64_t> wasm::detail::SinkRecorder::fLiveness(const std::vector<Block>& blocks, const std::vector<Access>& accesses, size_t words) const {
+	std::vector<uint64_t> use(blocks.size() * words, 0), def(blocks.size() * words, 0), in(blocks.size() * words, 0), out(words, 0);
+
+	/* collect the locals read before being written and the locals written by each block */
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		uint64_t* _use = use.data() + i * words, * _def = def.data() + i * words;
+		for (size_t j = blocks[i].first; j < blocks[i].last; ++j) {
+			uint32_t local = accesses[j].local;
+			uint64_t bit = (uint64_t(1) << (local % 64));
+			if (accesses[j].write)
+				_def[local / 64] |= bit;
+			else if ((_def[local / 64] & bit) == 0)
+				_use[local / 64] |= bit;
+		}
+	}
+
+	/* propagate the live locals backwards until a fixed point is reached */
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (size_t i = blocks.size(); i-- > 0;) {
+			std::fill(out.begin(), out.end(), 0);
+			for (uint32_t next : blocks[i].next) {
+				for (size_t w = 0; w < words; ++w)
+					out[w] |= in[next * words + w];
+			}
+			for (size_t w = 0; w < words; ++w) {
+				uint64_t value = use[i * words + w] | (out[w] & ~def[i * words + w]);
+				if (value == in[i * words + w])
+					continue;
+				in[i * words + w] = value;
+				changed = true;
+			}
+		}
+	}
+	return in;
+}
+std::vector<uint32_t> wasm::detail::SinkRecorder::fCoalesce(std::span<const detail::VariableState> variables, uint32_t parameter) const {
+	std::vector<uint32_t> mapping(variables.size());
+	for (uint32_t i = 0; i < parameter; ++i)
+		mapping[i] = i;
+	size_t count = variables.size() - parameter, words = (count + 63) / 64;
+	if (count == 0)
+		return mapping;
+
+	/* compute the locals, which are live at the start of each block */
+	std::vector<Block> blocks;
+	std::vector<Access> accesses;
+	fGraph(parameter, blocks, accesses);
+	std::vector<uint64_t> in = fLiveness(blocks, accesses, words);
+
+	/* construct the interference of all locals of the same type, by walking each block backwards and
+	*	letting every write interfere with all other locals live after it (the initial zero-value of the
+	*	locals does not need to be considered, as a write to any merged local would interfere with it) */
+	std::vector<uint64_t> matrix(count * words, 0), live(words, 0);
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		std::fill(live.begin(), live.end(), 0);
+		for (uint32_t next : blocks[i].next) {
+			for (size_t w = 0; w < words; ++w)
+				live[w] |= in[next * words + w];
+		}
+
+		for (size_t j = blocks[i].last; j-- > blocks[i].first;) {
+			uint32_t local = accesses[j].local;
+			uint64_t bit = (uint64_t(1) << (local % 64));
+			if (!accesses[j].write) {
+				live[local / 64] |= bit;
+				continue;
+			}
+			live[local / 64] &= ~bit;
+
+			wasm::Type type = variables[parameter + local].type;
+			for (size_t w = 0; w < words; ++w) {
+				for (uint64_t bits = live[w]; bits != 0; bits &= bits - 1) {
+					uint32_t other = uint32_t(w * 64 + std::countr_zero(bits));
+					if (variables[parameter + other].type != type)
+						continue;
+					matrix[local * words + other / 64] |= (uint64_t(1) << (other % 64));
+					matrix[other * words + local / 64] |= bit;
+				}
+			}
+		}
+	}
+
+	/* greedily assign each local to the first slot of the same type, which none of its locals interfere with */
+	std::vector<Slot> slots;
+	for (uint32_t i = 0; i < count; ++i) {
+		wasm::Type type = variables[parameter + i].type;
+		const uint64_t* row = matrix.data() + size_t(i) * words;
+
+		Slot* slot = 0;
+		for (Slot& next : slots) {
+			if (next.type == type && (next.conflicts[i / 64] & (uint64_t(1) << (i % 64))) == 0) {
+				slot = &next;
+				break;
+			}
+		}
+
+		/* allocate a new slot, or merge the interference of the local into the slot */
+		if (slot == 0) {
+			slots.push_back({ std::vector<uint64_t>{ row, row + words }, uint32_t(parameter + slots.size()), type });
+			slot = &slots.back();
+		}
+		else for (size_t w = 0; w < words; ++w)
+			slot->conflicts[w] |= row[w];
+		mapping[parameter + i] = slot->index;
+	}
+	return mapping;
+}
+
+uint32_t wasm::detail::SinkRecorder::fResolve(std::vector<Node>& nodes, uint32_t node) const {
+	while (nodes[node].alias != node) {
+		nodes[node].alias = nodes[nodes[node].alias].alias;
+		node = nodes[node].alias;
+	}
+	return node;
+}
+void wasm::detail::SinkRecorder::fSimplify() {
+	static constexpr uint32_t Root = std::numeric_limits<uint32_t>::max();
+	std::vector<Node> nodes;
+	std::vector<uint32_t> open, owner;
+	std::vector<Event> out;
+	size_t dead = 0;
+	bool root = false;
+
+	/* the events are rewritten into the output, while the scope-events reference their nodes through the owners,
+	*	and events are dropped while within a dead region (the branch of a conditional with a constant condition,
+	*	which is never taken, and which ends once the conditional at the depth of the region is toggled or closed) */
+	auto unreachable = [&]() -> bool& {
+		return (open.empty() ? root : nodes[open.back()].unreachable);
+		};
+	auto emit = [&](Event&& event, uint32_t node) {
+		out.push_back(std::move(event));
+		owner.push_back(node);
+		};
+	auto drop = [&]() {
+		out.pop_back();
+		owner.pop_back();
+		};
+	auto erase = [&](uint32_t node) {
+		nodes[node].removed = true;
+		if (nodes[node].scope == out.size() - 1)
+			drop();
+		};
+	auto fallthrough = [&](uint32_t node) {
+		/* remove the last branch to the end of the scope, if it leaves exactly the results on the stack */
+		if (out.empty() || nodes[node].type == wasm::ScopeType::loop)
+			return;
+		const Branch* branch = std::get_if<Branch>(&out.back());
+		if (branch == 0 || !branch->exact || fResolve(nodes, branch->depth) != node)
+			return;
+		--nodes[node].references;
+		drop();
+		};
+
+	for (size_t i = 0; i < pEvents.size(); ++i) {
+		Event& event = pEvents[i];
+
+		if (Scope* scope = std::get_if<Scope>(&event); scope != 0) {
+			uint32_t node = uint32_t(nodes.size());
+			bool inherited = unreachable();
+			nodes.push_back({ scope->prototype, node, 0, i, scope->type, Taken::any, inherited, inherited, true });
+			open.push_back(node);
+			if (dead != 0)
+				continue;
+
+			/* turn conditionals with a constant condition into blocks of the taken branch (the emitting of the
+			*	scope is deferred to the else-branch, if only the else-branch is taken, which starts as dead region) */
+			if (scope->type == wasm::ScopeType::conditional && !out.empty()) {
+				const wasm::InstConst* inst = std::get_if<wasm::InstConst>(&out.back());
+				if (inst != 0 && std::holds_alternative<uint32_t>(inst->value)) {
+					bool then = (std::get<uint32_t>(inst->value) != 0);
+					drop();
+					scope->type = wasm::ScopeType::block;
+					nodes[node].type = wasm::ScopeType::block;
+					nodes[node].taken = (then ? Taken::then : Taken::otherwise);
+					if (!then) {
+						dead = open.size();
+						continue;
+					}
+				}
+			}
+			nodes[node].scope = out.size();
+			nodes[node].removed = false;
+			emit(std::move(*scope), node);
+		}
+
+		else if (std::holds_alternative<Toggle>(event)) {
+			uint32_t node = open.back();
+			if (dead != 0 && open.size() > dead)
+				continue;
+			nodes[node].unreachable = nodes[node].inherited;
+
+			/* check if the dead then-branch ends, in which case the else-branch becomes the body of the block */
+			if (dead != 0) {
+				dead = 0;
+				Scope& scope = std::get<Scope>(pEvents[nodes[node].scope]);
+				nodes[node].scope = out.size();
+				nodes[node].removed = false;
+				emit(std::move(scope), node);
+				continue;
+			}
+
+			/* check if the else-branch is dead or if the branch to the end of the then-branch is superfluous */
+			fallthrough(node);
+			if (nodes[node].taken == Taken::then)
+				dead = open.size();
+			else
+				emit(Toggle{}, node);
+		}
+
+		else if (std::holds_alternative<Pop>(event)) {
+			uint32_t node = open.back();
+			open.pop_back();
+			if (dead != 0) {
+				if (open.size() >= dead)
+					continue;
+				dead = 0;
+				if (nodes[node].removed)
+					continue;
+			}
+			fallthrough(node);
+
+			/* remove empty else-branches, and replace conditionals without any instructions by dropping the condition */
+			if (nodes[node].type == wasm::ScopeType::conditional) {
+				if (owner.back() == node && std::holds_alternative<Toggle>(out.back()))
+					drop();
+				if (owner.back() == node && nodes[node].references == 0) {
+					out.back() = wasm::InstSimple{ wasm::InstSimple::Type::drop };
+					owner.back() = Root;
+					nodes[node].removed = true;
+					continue;
+				}
+				emit(Pop{ wasm::ScopeType::conditional }, node);
+				continue;
+			}
+
+			/* merge a block, which ends immediately before this block and produces the same results, into this
+			*	block (the stack below the nested results must be empty, as this block would otherwise be invalid) */
+			if (nodes[node].type == wasm::ScopeType::block && std::holds_alternative<Pop>(out.back())) {
+				uint32_t child = owner.back();
+				if (nodes[child].type == wasm::ScopeType::block && std::ranges::equal(nodes[child].prototype.resultTypes(), nodes[node].prototype.resultTypes())) {
+					drop();
+					erase(child);
+					nodes[child].alias = node;
+					nodes[node].references += nodes[child].references;
+				}
+			}
+
+			/* remove blocks and loops, which are never branched to, as their bodies are also valid in the parent scope */
+			if (nodes[node].references == 0)
+				erase(node);
+			else
+				emit(Pop{ nodes[node].type }, node);
+		}
+
+		else if (Branch* branch = std::get_if<Branch>(&event); branch != 0) {
+			if (dead != 0)
+				continue;
+
+			/* reference the nodes instead of depths (depths beyond the scopes reference the function itself) */
+			auto resolve = [&](uint32_t depth) -> uint32_t {
+				if (depth >= open.size())
+					return Root;
+				++nodes[open[open.size() - 1 - depth]].references;
+				return open[open.size() - 1 - depth];
+				};
+			branch->depth = resolve(branch->depth);
+			for (uint32_t& depth : branch->table)
+				depth = resolve(depth);
+			branch->exact = (branch->exact && !unreachable());
+			if (branch->type != wasm::InstBranch::Type::conditional)
+				unreachable() = true;
+			emit(std::move(*branch), Root);
+		}
+
+		else if (dead == 0) {
+			/* track the reachability of the instructions, which is required for the branches to be removed */
+			if (const wasm::InstSimple* inst = std::get_if<wasm::InstSimple>(&event); inst != 0)
+				unreachable() = (unreachable() || inst->type == wasm::InstSimple::Type::ret || inst->type == wasm::InstSimple::Type::unreachable);
+			else if (const wasm::InstFunction* inst = std::get_if<wasm::InstFunction>(&event); inst != 0)
+				unreachable() = (unreachable() || inst->type == wasm::InstFunction::Type::callTail);
+			else if (const wasm::InstIndirect* inst = std::get_if<wasm::InstIndirect>(&event); inst != 0)
+				unreachable() = (unreachable() || inst->type == wasm::InstIndirect::Type::callTail);
+			emit(std::move(event), Root);
+		}
+	}
+
+	/* drop the removed scopes and convert the referenced nodes of the branches back to depths */
+	std::vector<uint32_t> position(nodes.size(), 0);
+	uint32_t depth = 0;
+	pEvents.clear();
+	for (size_t i = 0; i < out.size(); ++i) {
+		if (std::holds_alternative<Scope>(out[i])) {
+			if (nodes[owner[i]].removed)
+				continue;
+			position[owner[i]] = depth++;
+		}
+		else if (std::holds_alternative<Pop>(out[i]))
+			--depth;
+		else if (Branch* branch = std::get_if<Branch>(&out[i]); branch != 0) {
+			auto convert = [&](uint32_t node) -> uint32_t {
+				return (node == Root ? depth : depth - 1 - position[fResolve(nodes, node)]);
+				};
+			branch->depth = convert(branch->depth);
+			for (uint32_t& entry : branch->table)
+				entry = convert(entry);
+		}
+		pEvents.push_back(std::move(out[i]));
+	}
+}
+
+bool wasm::detail::SinkRecorder::fInlinable(uint32_t size) const {
+	if (pEvents.size() > size)
+		return false;
+
+	/* the locals must be numeric, as they are reset by the callers before every inlined body */
+	for (size_t i = pParameter; i < pLocals.size(); ++i) {
+		if (pLocals[i] != wasm::Type::i32 && pLocals[i] != wasm::Type::i64 && pLocals[i] != wasm::Type::f32 && pLocals[i] != wasm::Type::f64)
+			return false;
+	}
+
+	/* tail-calls cannot be inlined, as they would have to return out of the caller */
+	for (const Event& event : pEvents) {
+		if (const wasm::InstFunction* inst = std::get_if<wasm::InstFunction>(&event); inst != 0 && inst->type == wasm::InstFunction::Type::callTail)
+			return false;
+		if (const wasm::InstIndirect* inst = std::get_if<wasm::InstIndirect>(&event); inst != 0 && inst->type == wasm::InstIndirect::Type::callTail)
+			return false;
+	}
+	return true;
+}
+
+void wasm::detail::SinkRecorder::pushScope(const wasm::Target& target) {
+	pEvents.emplace_back(Scope{ target.prototype(), std::u8string{ target.id() }, target.type() });
+}
+void wasm::detail::SinkRecorder::popScope(wasm::ScopeType type) {
+	pEvents.emplace_back(Pop{ type });
+}
+void wasm::detail::SinkRecorder::toggleConditional() {
+	pEvents.emplace_back(Toggle{});
+}
+void wasm::detail::SinkRecorder::close(const wasm::Sink&) {
+	/* the sink replays the body to the actual sink-interface and closes it */
+}
+void wasm::detail::SinkRecorder::addLocal(const wasm::Variable&) {
+	/* the locals are only passed to the actual sink-interface, once they have been merged */
+}
+void wasm::detail::SinkRecorder::addComment(std::u8string_view text) {
+	pEvents.emplace_back(Comment{ std::u8string{ text } });
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstSimple& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstConst& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstOperand& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstWidth& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstMemory& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstTable& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstLocal& inst) {
+	pEvents.push_back(Local{ inst.variable.index(), inst.type });
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstGlobal& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstFunction& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstIndirect& inst) {
+	pEvents.emplace_back(inst);
+}
+void wasm::detail::SinkRecorder::addInst(const wasm::InstBranch& inst) {
+	/* the targets are only referenced by the instruction, and are therefore recorded as relative depths,
+	*	while remembering if the table was originally given as depths (to replay the same instruction) */
+	Branch branch;
+	branch.type = inst.type;
+	branch.depth = inst.target.index();
+
+	/* remember if a branch to the current scope leaves exactly the results of the scope on the stack, in
+	*	which case the branch could be replaced by falling through to the end (requires the validated stack) */
+	if (inst.type == wasm::InstBranch::Type::direct && branch.depth == 0 && !pSink->pTrusted)
+		branch.exact = (pSink->pStack.size() == pSink->fScope().stack);
+	if (inst.type == wasm::InstBranch::Type::table) {
+		branch.relative = !inst.depths.empty();
+		if (branch.relative)
+			branch.table.assign(inst.depths.begin(), inst.depths.end());
+		else for (const wasm::WTarget& target : inst.targets())
+			branch.table.push_back(target.get().index());
+	}
+	pEvents.emplace_back(std::move(branch));
+}
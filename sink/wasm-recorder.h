@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "wasm-sink.h"
+
+#include <algorithm>
+
+namespace wasm::detail {
+	/* sink-interface, which records the validated body of a sink, to allow the sink to inline other functions, to simplify
+	*	its control-flow, and to merge its locals once it is closed, and to afterwards replay the body to the actual
+	*	sink-interface (the bodies of small functions are afterwards kept by the module to be inlined into their callers) */
+	class SinkRecorder final : public wasm::SinkInterface {
+		friend class wasm::Sink;
+	private:
+		struct Scope {
+			wasm::Prototype prototype;
+			std::u8string id;
+			wasm::ScopeType type = wasm::ScopeType::block;
+		};
+		struct Pop {
+			wasm::ScopeType type = wasm::ScopeType::block;
+		};
+		struct Toggle {};
+		struct Comment {
+			std::u8string text;
+		};
+		/* locals are recorded by their index only, as the body might outlive the sink, when it is kept for inlining */
+		struct Local {
+			uint32_t index = 0;
+			wasm::InstLocal::Type type = wasm::InstLocal::Type::get;
+		};
+		struct Branch {
+			std::vector<uint32_t> table;
+			uint32_t depth = 0;
+			wasm::InstBranch::Type type = wasm::InstBranch::Type::direct;
+			bool relative = false;
+			bool exact = false;
+		};
+		using Event = std::variant<wasm::InstSimple, wasm::InstConst, wasm::InstOperand, wasm::InstWidth, wasm::InstMemory, wasm::InstTable,
+			Local, wasm::InstGlobal, wasm::InstFunction, wasm::InstIndirect, Branch, Scope, Pop, Toggle, Comment>;
+
+		/* basic block of the control-flow graph, which references its local accesses */
+		struct Block {
+			std::vector<uint32_t> next;
+			size_t first = 0;
+			size_t last = 0;
+		};
+		struct Access {
+			uint32_t local = 0;
+			bool write = false;
+		};
+		struct Frame {
+			uint32_t header = 0;
+			uint32_t end = 0;
+			uint32_t condition = 0;
+			wasm::ScopeType type = wasm::ScopeType::block;
+			bool otherwise = false;
+		};
+
+		/* scope of the control-flow simplification, which is referenced by the branches until they are
+		*	converted back to depths (scopes merged into their parent are aliased to the parent) */
+		enum class Taken : uint8_t {
+			any,
+			then,
+			otherwise
+		};
+		struct Node {
+			wasm::Prototype prototype;
+			uint32_t alias = 0;
+			uint32_t references = 0;
+			size_t scope = 0;
+			wasm::ScopeType type = wasm::ScopeType::block;
+			Taken taken = Taken::any;
+			bool inherited = false;
+			bool unreachable = false;
+			bool removed = false;
+		};
+
+		struct Slot {
+			std::vector<uint64_t> conflicts;
+			uint32_t index = 0;
+			wasm::Type type = wasm::Type::i32;
+		};
+
+	private:
+		std::vector<Event> pEvents;
+		std::vector<wasm::Type> pLocals;
+		const wasm::Sink* pSink = 0;
+		wasm::SinkInterface* pTarget = 0;
+		uint32_t pParameter = 0;
+		uint32_t pDepth = 0;
+		bool pCoalesce = false;
+		bool pSimplify = false;
+
+	private:
+		uint32_t fResolve(std::vector<Node>& nodes, uint32_t node) const;
+		void fSimplify();
+		bool fInlinable(uint32_t size) const;
+		void fGraph(uint32_t parameter, std::vector<Block>& blocks, std::vector<Access>& accesses) const;
+		std::vector<uint64_t> fLiveness(const std::vector<Block>& blocks, const std::vector<Access>& accesses, size_t words) const;
+		std::vector<uint32_t> fCoalesce(std::span<const detail::VariableState> variables, uint32_t parameter) const;
+
+	public:
+		void pushScope(const wasm::Target& target) override;
+		void popScope(wasm::ScopeType type) override;
+		void toggleConditional() override;
+		void close(const wasm::Sink& sink) override;
+		void addLocal(const wasm::Variable& local) override;
+		void addComment(std::u8string_view text) override;
+		void addInst(const wasm::InstSimple& inst) override;
+		void addInst(const wasm::InstConst& inst) override;
+		void addInst(const wasm::InstOperand& inst) override;
+		void addInst(const wasm::InstWidth& inst) override;
+		void addInst(const wasm::InstMemory& inst) override;
+		void addInst(const wasm::InstTable& inst) override;
+		void addInst(const wasm::InstLocal& inst) override;
+		void addInst(const wasm::InstGlobal& inst) override;
+		void addInst(const wasm::InstFunction& inst) override;
+		void addInst(const wasm::InstIndirect& inst) override;
+		void addInst(const wasm::InstBranch& inst) override;
+	};
+}
@@ -1,9 +1,11 @@
 /* SPDX-License-Identifier: BSD-3-Clause */
 /* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
 #include "wasm-sink.h"
+#include "wasm-recorder.h"
 #include "../objects/wasm-module.h"
 
-wasm::Sink::Sink(const wasm::Function& function) {
+wasm::Sink::Sink(const wasm::Function& function) : Sink{ function, wasm::SinkOptions{ .trusted = function.valid() && function.module().pOptions.trustedSinks } } {}
+wasm::Sink::Sink(const wasm::Function& function, const wasm::SinkOptions& options) : pTrusted{ options.trusted } {
 	/* validate that the function can be used as sink-target */
 	if (!function.valid())
 		throw wasm::Exception{ "Functions must be constructed to create a sink to them" };
@@ -11,12 +13,23 @@ wasm::Sink::Sink(const wasm::Function& function) {
 		throw wasm::Exception{ "Sinks cannot be created for imported function [", function.toString(), ']' };
 	pModule = &function.module();
 
-	/* check if the module is closed or the function has already been bound */
+	/* check if the module is closed or the function has already been bound (the lock
+	*	also serializes the module-state against sinks of other threads, if concurrent) */
+	std::unique_lock<std::recursive_mutex> _lock = pModule->fLock();
 	pModule->fCheck();
 	if (pModule->pFunction.list[function.index()].bound)
 		throw wasm::Exception{ "Sink cannot be created for function [", function.toString(), "] for which a sink has already been created before" };
 	pModule->pFunction.list[function.index()].bound = true;
 
+	/* reuse the containers of a previously destroyed sink (to retain their capacity) */
+	if (!pModule->pSinkCache.empty()) {
+		detail::SinkCache& cache = pModule->pSinkCache.back();
+		pVariables.list.swap(cache.variables);
+		pVariables.ids.swap(cache.ids);
+		pTargets.swap(cache.targets);
+		pModule->pSinkCache.pop_back();
+	}
+
 	/* setup the sink-state */
 	pFunction = function;
 	const auto& params = function.prototype().parameter();
@@ -25,8 +38,17 @@ wasm::Sink::Sink(const wasm::Function& function) {
 	pParameter = uint32_t(pVariables.list.size());
 	pModule->pFunction.list[function.index()].sink = this;
 
-	/* setup the sink-interface */
+	/* setup the sink-interface (the body is recorded, if other functions are to be inlined, if the
+	*	control-flow is to be simplified, or if the locals are to be merged once the sink is closed) */
 	pInterface = pModule->pInterface->sink(pFunction);
+	if (options.coalesce || options.simplify || pModule->pInlineSize > 0) {
+		pRecorder = std::make_unique<detail::SinkRecorder>();
+		pRecorder->pSink = this;
+		pRecorder->pTarget = pInterface;
+		pRecorder->pCoalesce = options.coalesce;
+		pRecorder->pSimplify = options.simplify;
+		pInterface = pRecorder.get();
+	}
 }
 wasm::Sink::~Sink() {
 	try {
@@ -34,8 +56,16 @@ wasm::Sink::~Sink() {
 	}
 	catch (const wasm::Exception& e) {
 		/* defer the exception to the module */
+		std::unique_lock<std::recursive_mutex> _lock = pModule->fLock();
 		pModule->fDeferredException(e);
 	}
+
+	/* pass the cleared containers back to the module to be reused by the next sink */
+	pVariables.list.clear();
+	pVariables.ids.clear();
+	pTargets.clear();
+	std::unique_lock<std::recursive_mutex> _lock = pModule->fLock();
+	pModule->pSinkCache.push_back({ std::move(pVariables.list), std::move(pVariables.ids), std::move(pTargets) });
 }
 
 wasm::Type wasm::Sink::fMapOperand(wasm::OpType operand) const {
@@ -81,35 +111,217 @@ void wasm::Sink::fClose() {
 	pModule->pFunction.list[pFunction.index()].sink = 0;
 
 	/* perform the type checking */
-	if (!fScope().unreachable) {
+	if (!pTrusted && !fScope().unreachable) {
 		fPopTypes(pFunction.prototype(), false);
 		fCheckEmpty();
 	}
 
-	/* mark the sink as closed */
+	/* rewrite the recorded body and pass it to the actual sink-interface */
+	if (pRecorder != 0)
+		fReplay();
+
+	/* mark the sink as closed (the writer collects the function-bodies of all sinks) */
+	std::unique_lock<std::recursive_mutex> _lock = pModule->fLock();
 	pInterface->close(*this);
 }
+void wasm::Sink::fReplay() {
+	pInterface = pRecorder->pTarget;
+
+	/* inline the calls first, and simplify the control-flow afterwards, as the merging of
+	*	the locals benefits from both (the wrapping blocks can often be removed again) */
+	if (pModule->pInlineSize > 0)
+		fInline();
+	if (pRecorder->pSimplify)
+		pRecorder->fSimplify();
+
+	/* merge the locals and compact the variables, such that each slot takes over the
+	*	state of the first local assigned to it (slots are allocated in order of the locals) */
+	std::vector<uint32_t> mapping(pVariables.list.size());
+	if (pRecorder->pCoalesce)
+		mapping = pRecorder->fCoalesce(pVariables.list, pParameter);
+	else for (uint32_t i = 0; i < mapping.size(); ++i)
+		mapping[i] = i;
+	uint32_t count = pParameter;
+	for (size_t i = pParameter; i < pVariables.list.size(); ++i) {
+		if (mapping[i] == count)
+			pVariables.list[count++] = pVariables.list[i];
+	}
+	pVariables.list.resize(count);
+	for (uint32_t i = pParameter; i < count; ++i)
+		pInterface->addLocal(wasm::Variable{ *this, i });
+
+	/* replay the body, while reconstructing the scopes to be referenced by the instructions (the
+	*	temporary targets must be detached, as they would otherwise close their scopes when destroyed) */
+	std::vector<wasm::Target> targets;
+	try {
+		for (const detail::SinkRecorder::Event& event : pRecorder->pEvents) {
+			std::visit([&](const auto& inst) {
+				using Type = std::decay_t<decltype(inst)>;
+
+				if constexpr (std::is_same_v<Type, detail::SinkRecorder::Scope>) {
+					detail::TargetState state = { inst.prototype, inst.id, ++pNextStamp, inst.type, false };
+					pTargets.push_back({ std::move(state), {} });
+					targets.push_back(wasm::Target{ *this });
+					targets.back().pIndex = uint32_t(pTargets.size() - 1);
+					targets.back().pStamp = pNextStamp;
+					pInterface->pushScope(targets.back());
+				}
+				else if constexpr (std::is_same_v<Type, detail::SinkRecorder::Pop>) {
+					targets.back().pSink = 0;
+					targets.pop_back();
+					pTargets.pop_back();
+					pInterface->popScope(inst.type);
+				}
+				else if constexpr (std::is_same_v<Type, detail::SinkRecorder::Toggle>) {
+					pTargets.back().state.otherwise = true;
+					pInterface->toggleConditional();
+				}
+				else if constexpr (std::is_same_v<Type, detail::SinkRecorder::Comment>)
+					pInterface->addComment(inst.text);
+				else if constexpr (std::is_same_v<Type, detail::SinkRecorder::Branch>) {
+					const wasm::Target& target = targets[targets.size() - 1 - inst.depth];
+					if (inst.type != wasm::InstBranch::Type::table)
+						pInterface->addInst(wasm::InstBranch{ inst.type, target });
+					else if (inst.relative)
+						pInterface->addInst(wasm::InstBranch{ inst.type, std::span<const uint32_t>{ inst.table }, target });
+					else {
+						std::vector<wasm::WTarget> list;
+						for (uint32_t depth : inst.table)
+							list.emplace_back(targets[targets.size() - 1 - depth]);
+						pInterface->addInst(wasm::InstBranch{ inst.type, std::move(list), target });
+					}
+				}
+				else if constexpr (std::is_same_v<Type, detail::SinkRecorder::Local>)
+					pInterface->addInst(wasm::InstLocal{ inst.type, wasm::Variable{ *this, mapping[inst.index] } });
+				else
+					pInterface->addInst(inst);
+				}, event);
+		}
+	}
+	catch (...) {
+		for (wasm::Target& target : targets)
+			target.pSink = 0;
+		throw;
+	}
+
+	/* keep the final body of small functions, to be inlined into their callers (the locals are only recorded
+	*	by their indices, and branches returning out of the body are not possible) */
+	if (pModule->pInlineSize == 0 || pFunction.exported())
+		return;
+	pRecorder->pLocals.clear();
+	for (const detail::VariableState& variable : pVariables.list)
+		pRecorder->pLocals.push_back(variable.type);
+	pRecorder->pParameter = pParameter;
+	if (!pRecorder->fInlinable(pModule->pInlineSize))
+		return;
+	for (detail::SinkRecorder::Event& event : pRecorder->pEvents) {
+		if (detail::SinkRecorder::Local* inst = std::get_if<detail::SinkRecorder::Local>(&event); inst != 0)
+			inst->index = mapping[inst->index];
+	}
+	pRecorder->pSink = 0;
+	pRecorder->pTarget = 0;
+	std::unique_lock<std::recursive_mutex> _lock = pModule->fLock();
+	pModule->pInlined[pFunction.index()] = std::move(pRecorder);
+}
+void wasm::Sink::fInline() {
+	std::vector<detail::SinkRecorder::Event> events;
+	uint32_t depth = 0;
+
+	for (detail::SinkRecorder::Event& event : pRecorder->pEvents) {
+		/* lookup the kept body of directly called functions (the module only keeps bodies of already closed functions) */
+		const detail::SinkRecorder* inlined = 0;
+		if (const wasm::InstFunction* inst = std::get_if<wasm::InstFunction>(&event); inst != 0 && inst->type == wasm::InstFunction::Type::callNormal) {
+			std::unique_lock<std::recursive_mutex> _lock = pModule->fLock();
+			auto it = pModule->pInlined.find(inst->function.index());
+			if (it != pModule->pInlined.end() && it->second->pDepth < pModule->pInlineDepth)
+				inlined = it->second.get();
+		}
+		if (inlined == 0) {
+			events.push_back(std::move(event));
+			continue;
+		}
+		const wasm::Prototype prototype = std::get<wasm::InstFunction>(event).function.prototype();
+		depth = std::max(depth, inlined->pDepth + 1);
+
+		/* allocate fresh locals for the parameters and locals of the inlined body, and move the parameters from the stack into
+		*	their locals (the locals are reset explicitly, as the inlined body might be executed multiple times, such as in loops) */
+		uint32_t base = uint32_t(pVariables.list.size());
+		for (wasm::Type type : inlined->pLocals)
+			pVariables.list.push_back({ {}, type });
+		for (uint32_t i = inlined->pParameter; i-- > 0;)
+			events.push_back(detail::SinkRecorder::Local{ base + i, wasm::InstLocal::Type::set });
+		for (uint32_t i = inlined->pParameter; i < inlined->pLocals.size(); ++i) {
+			switch (inlined->pLocals[i]) {
+			case wasm::Type::i64:
+				events.push_back(wasm::InstConst{ uint64_t(0) });
+				break;
+			case wasm::Type::f32:
+				events.push_back(wasm::InstConst{ 0.0f });
+				break;
+			case wasm::Type::f64:
+				events.push_back(wasm::InstConst{ 0.0 });
+				break;
+			default:
+				events.push_back(wasm::InstConst{ uint32_t(0) });
+				break;
+			}
+			events.push_back(detail::SinkRecorder::Local{ base + i, wasm::InstLocal::Type::set });
+		}
+
+		/* wrap the body into a block, which takes the place of the function-scope (returns therefore become branches to the block), and
+		*	lookup its type internally, as the sink might only be closed while the module itself is being closed */
+		wasm::Prototype block;
+		{
+			std::unique_lock<std::recursive_mutex> _lock = pModule->fLock();
+			block = pModule->fPrototype({}, prototype.result());
+		}
+		events.push_back(detail::SinkRecorder::Scope{ block, {}, wasm::ScopeType::block });
+		uint32_t nesting = 0;
+		for (const detail::SinkRecorder::Event& inner : inlined->pEvents) {
+			if (std::holds_alternative<detail::SinkRecorder::Scope>(inner))
+				++nesting;
+			else if (std::holds_alternative<detail::SinkRecorder::Pop>(inner))
+				--nesting;
+			else if (const wasm::InstSimple* inst = std::get_if<wasm::InstSimple>(&inner); inst != 0 && inst->type == wasm::InstSimple::Type::ret) {
+				detail::SinkRecorder::Branch branch;
+				branch.depth = nesting;
+				events.push_back(std::move(branch));
+				continue;
+			}
+			else if (const detail::SinkRecorder::Local* inst = std::get_if<detail::SinkRecorder::Local>(&inner); inst != 0) {
+				events.push_back(detail::SinkRecorder::Local{ base + inst->index, inst->type });
+				continue;
+			}
+			events.push_back(inner);
+		}
+		events.push_back(detail::SinkRecorder::Pop{ wasm::ScopeType::block });
+	}
+	pRecorder->pEvents.swap(events);
+	pRecorder->pDepth = depth;
+}
 void wasm::Sink::fDeferredException(const wasm::Exception& error) {
 	if (pException.empty())
 		pException = error.what();
 }
 wasm::Variable wasm::Sink::fParam(uint32_t index) {
-	/* validate the parameter-index */
-	if (index >= pParameter)
+	/* validate the parameter-index (unless the sink is trusted) */
+	if (!pTrusted && index >= pParameter)
 		throw wasm::Exception{ fError(), "Parameter index [", index, "] out of bounds" };
 	return wasm::Variable{ *this, index };
 }
 
 void wasm::Sink::fPopUntil(uint32_t size) {
 	while (pTargets.size() > size) {
-		/* perform the type checking (only if this is not a cleanup after a potential exception) */
-		if (!pTargets.back().scope.unreachable) {
-			fPopTypes(pTargets.back().state.prototype, false);
-			fCheckEmpty();
+		/* perform the type checking (only if this is not a cleanup after a potential exception, and the sink is not trusted) */
+		if (!pTrusted) {
+			if (!pTargets.back().scope.unreachable) {
+				fPopTypes(pTargets.back().state.prototype, false);
+				fCheckEmpty();
+			}
+			else
+				pStack.truncate(pTargets.back().scope.stack);
+			fPushTypes(pTargets.back().state.prototype, false);
 		}
-		else
-			pStack.resize(pTargets.back().scope.stack);
-		fPushTypes(pTargets.back().state.prototype, false);
 
 		/* notify the interface about the removed target and remove it */
 		pInterface->popScope(pTargets.back().state.type);
@@ -124,21 +336,24 @@ bool wasm::Sink::fCheckTarget(uint32_t index, size_t stamp, bool soft) const {
 	return false;
 }
 void wasm::Sink::fSetupValidTarget(const wasm::Prototype& prototype, std::u8string_view id, wasm::ScopeType type, wasm::Target& target) {
-	/* validate the prototype */
-	if (!prototype.valid())
-		throw wasm::Exception{ fError(), "Prototype must be constructed" };
-	if (&prototype.module() != pModule)
-		throw wasm::Exception{ fError(), "Prototype [", prototype.toString(), "] must originate from same module as function" };
-
-	/* perform the type checking */
-	if (type == wasm::ScopeType::conditional)
-		fPopTypes({ wasm::Type::i32 });
-	fPopTypes(prototype, true);
-	fPushTypes(prototype, true);
+	Scope scope;
+
+	/* validate the prototype and perform the type checking (unless the sink is trusted) */
+	if (!pTrusted) {
+		if (!prototype.valid())
+			throw wasm::Exception{ fError(), "Prototype must be constructed" };
+		if (&prototype.module() != pModule)
+			throw wasm::Exception{ fError(), "Prototype [", prototype.toString(), "] must originate from same module as function" };
+
+		if (type == wasm::ScopeType::conditional)
+			fPopTypes({ wasm::Type::i32 });
+		fPopTypes(prototype, true);
+		fPushTypes(prototype, true);
+		scope = { pStack.size() - prototype.parameter().size(), fScope().unreachable };
+	}
 
 	/* no need to validate the uniqueness of the id, as the name can be duplicated */
 	detail::TargetState state = { prototype, std::u8string{ id }, ++pNextStamp, type, false };
-	Scope scope = { pStack.size() - prototype.parameter().size(), fScope().unreachable };
 	pTargets.push_back({ std::move(state), scope });
 	uint32_t index = uint32_t(pTargets.size() - 1);
 
@@ -153,7 +368,7 @@ void wasm::Sink::fSetupTarget(const wasm::Prototype& prototype, std::u8string_vi
 	fCheck();
 	fSetupValidTarget(prototype, id, type, target);
 }
-void wasm::Sink::fSetupTarget(std::vector<wasm::Type> params, std::vector<wasm::Type> result, std::u8string_view id, wasm::ScopeType type, wasm::Target& target) {
+void wasm::Sink::fSetupTarget(wasm::TypeList params, wasm::TypeList result, std::u8string_view id, wasm::ScopeType type, wasm::Target& target) {
 	fCheck();
 	fSetupValidTarget(pModule->prototype(params, result), id, type, target);
 }
@@ -169,13 +384,15 @@ void wasm::Sink::fToggleTarget(uint32_t index, size_t stamp) {
 	pTargets.back().state.otherwise = true;
 
 	/* perform the type checking (i.e. the closed block returned all expected parameter) and restore the state */
-	if (!pTargets.back().scope.unreachable) {
-		fPopTypes(pTargets.back().state.prototype, false);
-		fCheckEmpty();
+	if (!pTrusted) {
+		if (!pTargets.back().scope.unreachable) {
+			fPopTypes(pTargets.back().state.prototype, false);
+			fCheckEmpty();
+		}
+		pTargets.back().scope.unreachable = false;
+		pStack.truncate(pTargets.back().scope.stack);
+		fPushTypes(pTargets.back().state.prototype, true);
 	}
-	pTargets.back().scope.unreachable = false;
-	pStack.resize(pTargets.back().scope.stack);
-	fPushTypes(pTargets.back().state.prototype, true);
 
 	/* notify the interface about the changed scope */
 	pInterface->toggleConditional();
@@ -215,13 +432,16 @@ wasm::Sink::Scope& wasm::Sink::fScope() {
 	return pTargets.back().scope;
 }
 void wasm::Sink::fPopTypes(std::initializer_list<wasm::Type> types) {
+	fPopTypes(std::span<const wasm::Type>{ types.begin(), types.size() });
+}
+void wasm::Sink::fPopTypes(std::span<const wasm::Type> types) {
 	Scope& scope = fScope();
 	if (scope.unreachable)
 		return;
 
 	/* validate that the given types exist and pop them */
-	if (pStack.size() - scope.stack >= types.size() && std::equal(pStack.end() - types.size(), pStack.end(), types.begin())) {
-		pStack.resize(pStack.size() - types.size());
+	if (pStack.size() - scope.stack >= types.size() && pStack.top(types)) {
+		pStack.truncate(pStack.size() - types.size());
 		return;
 	}
 
@@ -230,54 +450,21 @@ void wasm::Sink::fPopTypes(std::initializer_list<wasm::Type> types) {
 	fPopFailed(types.size(), expected);
 }
 void wasm::Sink::fPopTypes(const wasm::Prototype& prototype, bool params) {
-	Scope& scope = fScope();
-	if (scope.unreachable)
-		return;
-
-	/* validate that the given types exist and pop them */
-	std::string expected;
-	size_t count = 0;
-	if (params) {
-		const auto& list = prototype.parameter();
-
-		/* check for a match */
-		if (pStack.size() - scope.stack >= list.size() && std::equal(pStack.end() - list.size(), pStack.end(), list.begin(),
-			[](wasm::Type l, const wasm::Param& r) { return (l == r.type); })) {
-			pStack.resize(pStack.size() - list.size());
-			return;
-		}
-
-		/* setup the description of the expected types */
-		expected = fMakeTypeList(list.begin(), list.end(), [](auto& p) { return p.type; });
-		count = list.size();
-	}
-	else {
-		const auto& list = prototype.result();
-
-		/* check for a match */
-		if (pStack.size() - scope.stack >= list.size() && std::equal(pStack.end() - list.size(), pStack.end(), list.begin())) {
-			pStack.resize(pStack.size() - list.size());
-			return;
-		}
-
-		/* setup the description of the expected types */
-		expected = fMakeTypeList(list.begin(), list.end(), [](auto& t) { return t; });
-		count = list.size();
-	}
-	fPopFailed(count, expected);
+	fPopTypes(params ? prototype.parameterTypes() : prototype.resultTypes());
 }
 void wasm::Sink::fSwapTypes(std::initializer_list<wasm::Type> pop, std::initializer_list<wasm::Type> push) {
 	fPopTypes(pop);
 	fPushTypes(push);
 }
+void wasm::Sink::fSwapTypes(const detail::InstInfo& info) {
+	fPopTypes(std::span<const wasm::Type>{ info.pop, info.popCount });
+	pStack.push(std::span<const wasm::Type>{ &info.push, info.pushCount });
+}
 void wasm::Sink::fPushTypes(std::initializer_list<wasm::Type> types) {
-	pStack.insert(pStack.end(), types.begin(), types.end());
+	pStack.push(std::span<const wasm::Type>{ types.begin(), types.size() });
 }
 void wasm::Sink::fPushTypes(const wasm::Prototype& prototype, bool params) {
-	if (params) for (size_t i = 0; i < prototype.parameter().size(); ++i)
-		pStack.push_back(prototype.parameter()[i].type);
-	else
-		pStack.insert(pStack.end(), prototype.result().begin(), prototype.result().end());
+	pStack.push(params ? prototype.parameterTypes() : prototype.resultTypes());
 }
 
 wasm::Variable wasm::Sink::param(uint32_t index) {
@@ -319,8 +506,23 @@ wasm::List<wasm::Variable, wasm::Sink::LocalList> wasm::Sink::locals() const {
 	return { Sink::LocalList{ const_cast<wasm::Sink*>(this) } };
 }
 
-void wasm::Sink::operator[](const wasm::InstSimple& inst) {
+wasm::ModuleInterface* wasm::Sink::fWriter(const wasm::Function& function) {
+	return function.module().pInterface;
+}
+wasm::SinkInterface* wasm::Sink::fInterface() {
+	/* basic sinks pass their instructions directly to the writer, and can therefore neither record their
+	*	body nor inline other functions (the recorder can only exist due to the inlining of the module) */
+	if (pRecorder != 0) {
+		pInterface = pRecorder->pTarget;
+		pRecorder.reset();
+	}
+	return pInterface;
+}
+void wasm::Sink::fAdd(const wasm::InstSimple& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* perform the type checking */
 	switch (inst.type) {
@@ -342,12 +544,6 @@ void wasm::Sink::operator[](const wasm::InstSimple& inst) {
 			fSwapTypes({ type, type, wasm::Type::i32 }, { type });
 		}
 		break;
-	case wasm::InstSimple::Type::selectRefFunction:
-		fSwapTypes({ wasm::Type::refFunction, wasm::Type::refFunction, wasm::Type::i32 }, { wasm::Type::refFunction });
-		break;
-	case wasm::InstSimple::Type::selectRefExtern:
-		fSwapTypes({ wasm::Type::refExtern, wasm::Type::refExtern, wasm::Type::i32 }, { wasm::Type::refExtern });
-		break;
 	case wasm::InstSimple::Type::refTestNull:
 		if (pStack.size() - fScope().stack < 1 || (pStack.back() != wasm::Type::refExtern && pStack.back() != wasm::Type::refFunction))
 			fPopFailed(1, "ref");
@@ -355,39 +551,20 @@ void wasm::Sink::operator[](const wasm::InstSimple& inst) {
 			fSwapTypes({ pStack.back() }, { wasm::Type::i32 });
 		}
 		break;
-	case wasm::InstSimple::Type::refNullFunction:
-		fPushTypes({ wasm::Type::refFunction });
-		break;
-	case wasm::InstSimple::Type::refNullExtern:
-		fPushTypes({ wasm::Type::refExtern });
-		break;
-	case wasm::InstSimple::Type::expandIntSigned:
-	case wasm::InstSimple::Type::expandIntUnsigned:
-		fSwapTypes({ wasm::Type::i32 }, { wasm::Type::i64 });
-		break;
-	case wasm::InstSimple::Type::shrinkInt:
-		fSwapTypes({ wasm::Type::i64 }, { wasm::Type::i32 });
-		break;
-	case wasm::InstSimple::Type::expandFloat:
-		fSwapTypes({ wasm::Type::f32 }, { wasm::Type::f64 });
-		break;
-	case wasm::InstSimple::Type::shrinkFloat:
-		fSwapTypes({ wasm::Type::f64 }, { wasm::Type::f32 });
-		break;
 	case wasm::InstSimple::Type::unreachable:
 		fScope().unreachable = true;
 		break;
-	case wasm::InstSimple::Type::nop:
-		break;
 	default:
-		throw wasm::Exception{ "Unknown wasm::InstSimple type [", size_t(inst.type), "] encountered" };
+		/* all remaining instructions are fully described by their signature */
+		fSwapTypes(detail::GetInfo(inst));
+		break;
 	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
 }
-void wasm::Sink::operator[](const wasm::InstConst& inst) {
+void wasm::Sink::fAdd(const wasm::InstConst& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* perform the type checking */
 	if (std::holds_alternative<uint32_t>(inst.value))
@@ -400,117 +577,30 @@ void wasm::Sink::operator[](const wasm::InstConst& inst) {
 		fPushTypes({ wasm::Type::f64 });
 	else
 		throw wasm::Exception{ "Unknown wasm::InstConst type encountered" };
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
 }
-void wasm::Sink::operator[](const wasm::InstOperand& inst) {
+void wasm::Sink::fAdd(const wasm::InstOperand& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* perform the type checking */
-	wasm::Type type = fMapOperand(inst.operand);
-	if (inst.type == wasm::InstOperand::Type::equal || inst.type == wasm::InstOperand::Type::notEqual)
-		fSwapTypes({ type, type }, { wasm::Type::i32 });
-	else
-		fSwapTypes({ type, type }, { type });
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
+	fSwapTypes(detail::GetInfo(inst));
 }
-void wasm::Sink::operator[](const wasm::InstWidth& inst) {
+void wasm::Sink::fAdd(const wasm::InstWidth& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* perform the type checking */
-	wasm::Type itype = (inst.width32 ? wasm::Type::i32 : wasm::Type::i64), ftype = (inst.width32 ? wasm::Type::f32 : wasm::Type::f64);
-	switch (inst.type) {
-	case wasm::InstWidth::Type::equalZero:
-		fSwapTypes({ itype }, { wasm::Type::i32 });
-		break;
-	case wasm::InstWidth::Type::greater:
-	case wasm::InstWidth::Type::less:
-	case wasm::InstWidth::Type::greaterEqual:
-	case wasm::InstWidth::Type::lessEqual:
-		fSwapTypes({ ftype, ftype }, { wasm::Type::i32 });
-		break;
-	case wasm::InstWidth::Type::greaterSigned:
-	case wasm::InstWidth::Type::greaterUnsigned:
-	case wasm::InstWidth::Type::lessSigned:
-	case wasm::InstWidth::Type::lessUnsigned:
-	case wasm::InstWidth::Type::greaterEqualSigned:
-	case wasm::InstWidth::Type::greaterEqualUnsigned:
-	case wasm::InstWidth::Type::lessEqualSigned:
-	case wasm::InstWidth::Type::lessEqualUnsigned:
-		fSwapTypes({ itype, itype }, { wasm::Type::i32 });
-		break;
-	case wasm::InstWidth::Type::divSigned:
-	case wasm::InstWidth::Type::divUnsigned:
-	case wasm::InstWidth::Type::modSigned:
-	case wasm::InstWidth::Type::modUnsigned:
-	case wasm::InstWidth::Type::bitAnd:
-	case wasm::InstWidth::Type::bitOr:
-	case wasm::InstWidth::Type::bitXOr:
-	case wasm::InstWidth::Type::bitShiftLeft:
-	case wasm::InstWidth::Type::bitShiftRightSigned:
-	case wasm::InstWidth::Type::bitShiftRightUnsigned:
-	case wasm::InstWidth::Type::bitRotateLeft:
-	case wasm::InstWidth::Type::bitRotateRight:
-		fSwapTypes({ itype, itype }, { itype });
-		break;
-	case wasm::InstWidth::Type::bitLeadingNulls:
-	case wasm::InstWidth::Type::bitTrailingNulls:
-	case wasm::InstWidth::Type::bitSetCount:
-		fSwapTypes({ itype }, { itype });
-		break;
-	case wasm::InstWidth::Type::convertToF32Signed:
-	case wasm::InstWidth::Type::convertToF32Unsigned:
-		fSwapTypes({ itype }, { wasm::Type::f32 });
-		break;
-	case wasm::InstWidth::Type::convertToF64Signed:
-	case wasm::InstWidth::Type::convertToF64Unsigned:
-		fSwapTypes({ itype }, { wasm::Type::f64 });
-		break;
-	case wasm::InstWidth::Type::convertFromF32SignedTrap:
-	case wasm::InstWidth::Type::convertFromF32UnsignedTrap:
-	case wasm::InstWidth::Type::convertFromF32SignedNoTrap:
-	case wasm::InstWidth::Type::convertFromF32UnsignedNoTrap:
-		fSwapTypes({ wasm::Type::f32 }, { itype });
-		break;
-	case wasm::InstWidth::Type::convertFromF64SignedTrap:
-	case wasm::InstWidth::Type::convertFromF64UnsignedTrap:
-	case wasm::InstWidth::Type::convertFromF64SignedNoTrap:
-	case wasm::InstWidth::Type::convertFromF64UnsignedNoTrap:
-		fSwapTypes({ wasm::Type::f64 }, { itype });
-		break;
-	case wasm::InstWidth::Type::reinterpretAsFloat:
-		fSwapTypes({ itype }, { ftype });
-		break;
-	case wasm::InstWidth::Type::reinterpretAsInt:
-		fSwapTypes({ ftype }, { itype });
-		break;
-	case wasm::InstWidth::Type::floatDiv:
-	case wasm::InstWidth::Type::floatMin:
-	case wasm::InstWidth::Type::floatMax:
-	case wasm::InstWidth::Type::floatCopySign:
-		fSwapTypes({ ftype, ftype }, { ftype });
-		break;
-	case wasm::InstWidth::Type::floatFloor:
-	case wasm::InstWidth::Type::floatRound:
-	case wasm::InstWidth::Type::floatCeil:
-	case wasm::InstWidth::Type::floatTruncate:
-	case wasm::InstWidth::Type::floatAbsolute:
-	case wasm::InstWidth::Type::floatNegate:
-	case wasm::InstWidth::Type::floatSquareRoot:
-		fSwapTypes({ ftype }, { ftype });
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstWidth type [", size_t(inst.type), "] encountered" };
-	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
+	fSwapTypes(detail::GetInfo(inst));
 }
-void wasm::Sink::operator[](const wasm::InstMemory& inst) {
+void wasm::Sink::fAdd(const wasm::InstMemory& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* validate the instruction-operands */
 	if (!inst.memory.valid())
@@ -575,12 +665,12 @@ void wasm::Sink::operator[](const wasm::InstMemory& inst) {
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstMemory type [", size_t(inst.type), "] encountered" };
 	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
 }
-void wasm::Sink::operator[](const wasm::InstTable& inst) {
+void wasm::Sink::fAdd(const wasm::InstTable& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* validate the instruction-operands */
 	if (!inst.table.valid())
@@ -617,12 +707,12 @@ void wasm::Sink::operator[](const wasm::InstTable& inst) {
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstTable type [", size_t(inst.type), "] encountered" };
 	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
 }
-void wasm::Sink::operator[](const wasm::InstLocal& inst) {
+void wasm::Sink::fAdd(const wasm::InstLocal& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* validate the instruction-operands */
 	if (!inst.variable.valid())
@@ -644,27 +734,12 @@ void wasm::Sink::operator[](const wasm::InstLocal& inst) {
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstLocal type [", size_t(inst.type), "] encountered" };
 	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
-}
-void wasm::Sink::operator[](const wasm::InstParam& inst) {
-	switch (inst.type) {
-	case wasm::InstParam::Type::get:
-		wasm::Sink::operator[](wasm::InstLocal{ wasm::InstLocal::Type::get, fParam(inst.index) });
-		break;
-	case wasm::InstParam::Type::set:
-		wasm::Sink::operator[](wasm::InstLocal{ wasm::InstLocal::Type::set, fParam(inst.index) });
-		break;
-	case wasm::InstParam::Type::tee:
-		wasm::Sink::operator[](wasm::InstLocal{ wasm::InstLocal::Type::tee, fParam(inst.index) });
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstParam type [", size_t(inst.type), "] encountered" };
-	}
 }
-void wasm::Sink::operator[](const wasm::InstGlobal& inst) {
+void wasm::Sink::fAdd(const wasm::InstGlobal& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* validate the instruction-operands */
 	if (!inst.global.valid())
@@ -683,12 +758,12 @@ void wasm::Sink::operator[](const wasm::InstGlobal& inst) {
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstGlobal type [", size_t(inst.type), "] encountered" };
 	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
 }
-void wasm::Sink::operator[](const wasm::InstFunction& inst) {
+void wasm::Sink::fAdd(const wasm::InstFunction& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* validate the instruction-operands */
 	if (!inst.function.valid())
@@ -718,12 +793,12 @@ void wasm::Sink::operator[](const wasm::InstFunction& inst) {
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstFunction type [", size_t(inst.type), "] encountered" };
 	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
 }
-void wasm::Sink::operator[](const wasm::InstIndirect& inst) {
+void wasm::Sink::fAdd(const wasm::InstIndirect& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* validate the instruction-operands */
 	if (!inst.table.valid())
@@ -756,27 +831,32 @@ void wasm::Sink::operator[](const wasm::InstIndirect& inst) {
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstIndirect type [", size_t(inst.type), "] encountered" };
 	}
-
-	/* add the instruction to the interface */
-	pInterface->addInst(inst);
 }
-void wasm::Sink::operator[](const wasm::InstBranch& inst) {
+void wasm::Sink::fAdd(const wasm::InstBranch& inst) {
+	/* trusted sinks only check that the sink is still open, and skip any validation and type checking */
 	fCheck();
+	if (pTrusted)
+		return;
 
 	/* validate the instruction-operands */
 	if (!inst.target.valid())
 		throw wasm::Exception{ fError(), "Targets must be constructed and not out of scope" };
 	if (&inst.target.sink() != this)
 		throw wasm::Exception{ fError(), "Target [", inst.target.toString(), "] must originate from sink" };
+	std::span<const wasm::WTarget> targets = inst.targets();
 	if (inst.type == wasm::InstBranch::Type::table) {
-		for (size_t i = 0; i < inst.list.size(); ++i) {
-			const wasm::Target& target = inst.list.begin()[i];
+		for (size_t i = 0; i < targets.size(); ++i) {
+			const wasm::Target& target = targets[i];
 
 			if (!target.valid())
 				throw wasm::Exception{ fError(), "Targets must be constructed and not out of scope" };
 			if (&target.sink() != this)
 				throw wasm::Exception{ fError(), "Target [", target.toString(), "] must originate from sink" };
 		}
+		for (size_t i = 0; i < inst.depths.size(); ++i) {
+			if (inst.depths[i] >= pTargets.size())
+				throw wasm::Exception{ fError(), "Target depth [", inst.depths[i], "] is out of scope" };
+		}
 	}
 
 	/* extract the state of the target */
@@ -793,22 +873,96 @@ void wasm::Sink::operator[](const wasm::InstBranch& inst) {
 		fPopTypes(state.prototype, state.type == wasm::ScopeType::loop);
 		fPushTypes(state.prototype, state.type == wasm::ScopeType::loop);
 		break;
-	case wasm::InstBranch::Type::table:
+	case wasm::InstBranch::Type::table: {
 		fPopTypes({ wasm::Type::i32 });
-		for (size_t i = 0; i <= inst.list.size(); ++i) {
-			const detail::TargetState& temp = (i == inst.list.size() ? state : pTargets[inst.list.begin()[i].get().pIndex].state);
-			fPopTypes(temp.prototype, temp.type == wasm::ScopeType::loop);
-			fPushTypes(temp.prototype, temp.type == wasm::ScopeType::loop);
-		}
+
+		/* check each distinct label-signature only once, as large tables typically only reference few different targets */
+		std::span<const wasm::Type> last;
+		auto check = [&](const detail::TargetState& temp) {
+			std::span<const wasm::Type> types = (temp.type == wasm::ScopeType::loop ? temp.prototype.parameterTypes() : temp.prototype.resultTypes());
+			if (types.data() == last.data() && types.size() == last.size())
+				return;
+			fPopTypes(types);
+			pStack.push(types);
+			last = types;
+		};
+		for (size_t i = 0; i < targets.size(); ++i)
+			check(pTargets[targets[i].get().pIndex].state);
+		for (size_t i = 0; i < inst.depths.size(); ++i)
+			check(pTargets[pTargets.size() - inst.depths[i] - 1].state);
+		check(state);
 		fScope().unreachable = true;
 		break;
+	}
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstBranch type [", size_t(inst.type), "] encountered" };
 	}
-
-	/* add the instruction to the interface */
+}
+void wasm::Sink::operator[](const wasm::InstSimple& inst) {
+	fAdd(inst);
 	pInterface->addInst(inst);
 }
+void wasm::Sink::operator[](const wasm::InstConst& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstOperand& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstWidth& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstMemory& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstTable& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstLocal& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstParam& inst) {
+	switch (inst.type) {
+	case wasm::InstParam::Type::get:
+		wasm::Sink::operator[](wasm::InstLocal{ wasm::InstLocal::Type::get, fParam(inst.index) });
+		break;
+	case wasm::InstParam::Type::set:
+		wasm::Sink::operator[](wasm::InstLocal{ wasm::InstLocal::Type::set, fParam(inst.index) });
+		break;
+	case wasm::InstParam::Type::tee:
+		wasm::Sink::operator[](wasm::InstLocal{ wasm::InstLocal::Type::tee, fParam(inst.index) });
+		break;
+	default:
+		throw wasm::Exception{ "Unknown wasm::InstParam type [", size_t(inst.type), "] encountered" };
+	}
+}
+void wasm::Sink::operator[](const wasm::InstGlobal& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstFunction& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstIndirect& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](const wasm::InstBranch& inst) {
+	fAdd(inst);
+	pInterface->addInst(inst);
+}
+void wasm::Sink::operator[](std::span<const wasm::InstAny> insts) {
+	fAdd(insts, [this](std::span<const wasm::InstAny> valid) { pInterface->addInsts(valid); });
+}
+void wasm::Sink::operator[](std::initializer_list<wasm::InstAny> insts) {
+	wasm::Sink::operator[](std::span<const wasm::InstAny>{ insts.begin(), insts.size() });
+}
 
 
 std::u8string wasm::Variable::toString() const {
@@ -6,9 +6,13 @@
 #include "../objects/wasm-function.h"
 #include "../objects/wasm-global.h"
 #include "../inst/wasm-instruction.h"
+#include "../inst/wasm-instinfo.h"
 #include "wasm-variable.h"
+#include "wasm-typestack.h"
 #include "wasm-target.h"
 
+#include <memory>
+
 namespace wasm {
 	/* sink interface used to write the instructions out */
 	class SinkInterface {
@@ -30,13 +34,38 @@ namespace wasm {
 		virtual void addInst(const wasm::InstFunction& inst) = 0;
 		virtual void addInst(const wasm::InstIndirect& inst) = 0;
 		virtual void addInst(const wasm::InstBranch& inst) = 0;
+
+		/* add a batch of already validated instructions (defaults to adding them individually) */
+		virtual void addInsts(std::span<const wasm::InstAny> insts) {
+			for (const wasm::InstAny& inst : insts)
+				detail::VisitInst(inst, [this](const auto& value) { addInst(value); });
+		}
 	};
 
+	namespace detail {
+		struct SinkScope {
+			size_t stack = 0;
+			bool unreachable = false;
+		};
+		struct SinkTarget {
+			detail::TargetState state;
+			detail::SinkScope scope;
+		};
+
+		/* containers of a destroyed sink, which are kept by the module to be reused by the next sink (retains their capacity) */
+		struct SinkCache {
+			std::vector<detail::VariableState> variables;
+			std::unordered_set<std::u8string> ids;
+			std::vector<detail::SinkTarget> targets;
+		};
+	}
+
 	/* write instructions out to a function bound to the given sink out to the sink-implementation */
 	class Sink {
 		template <class> friend class detail::SinkMember;
 		friend class wasm::Module;
 		friend class wasm::Target;
+		friend class detail::SinkRecorder;
 	private:
 		struct LocalList {
 			wasm::Sink* _this = 0;
@@ -48,14 +77,8 @@ namespace wasm {
 				return wasm::Variable{ *_this, index + _this->pParameter };
 			}
 		};
-		struct Scope {
-			size_t stack = 0;
-			bool unreachable = false;
-		};
-		struct Scopes {
-			detail::TargetState state;
-			Scope scope;
-		};
+		using Scope = detail::SinkScope;
+		using Scopes = detail::SinkTarget;
 
 	private:
 		wasm::Module* pModule = 0;
@@ -64,17 +87,20 @@ namespace wasm {
 			std::unordered_set<std::u8string> ids;
 		} pVariables;
 		std::vector<Scopes> pTargets;
-		std::vector<wasm::Type> pStack;
+		detail::TypeStack pStack;
 		Scope pRoot;
 		wasm::Function pFunction;
 		wasm::SinkInterface* pInterface = 0;
+		std::unique_ptr<detail::SinkRecorder> pRecorder;
 		mutable std::string pException;
 		size_t pNextStamp = 0;
 		uint32_t pParameter = 0;
 		bool pClosed = false;
+		bool pTrusted = false;
 
 	public:
 		Sink(const wasm::Function& function);
+		Sink(const wasm::Function& function, const wasm::SinkOptions& options);
 		Sink() = delete;
 		Sink(wasm::Sink&&) = delete;
 		Sink(const wasm::Sink&) = delete;
@@ -85,15 +111,16 @@ namespace wasm {
 		std::u8string fError() const;
 		void fCheck() const;
 		void fClose();
+		void fReplay();
+		void fInline();
 		void fDeferredException(const wasm::Exception& error);
-		wasm::Variable fParam(uint32_t index);
 
 	private:
 		void fPopUntil(uint32_t size);
 		bool fCheckTarget(uint32_t index, size_t stamp, bool soft) const;
 		void fSetupValidTarget(const wasm::Prototype& prototype, std::u8string_view id, wasm::ScopeType type, wasm::Target& target);
 		void fSetupTarget(const wasm::Prototype& prototype, std::u8string_view id, wasm::ScopeType type, wasm::Target& target);
-		void fSetupTarget(std::vector<wasm::Type> params, std::vector<wasm::Type> result, std::u8string_view id, wasm::ScopeType type, wasm::Target& target);
+		void fSetupTarget(wasm::TypeList params, wasm::TypeList result, std::u8string_view id, wasm::ScopeType type, wasm::Target& target);
 		void fToggleTarget(uint32_t index, size_t stamp);
 		void fCloseTarget(uint32_t index, size_t stamp);
 
@@ -143,11 +170,47 @@ namespace wasm {
 		const Scope& fScope() const;
 		Scope& fScope();
 		void fPopTypes(const wasm::Prototype& prototype, bool params);
+		void fPopTypes(std::span<const wasm::Type> types);
 		void fPopTypes(std::initializer_list<wasm::Type> types);
 		void fSwapTypes(std::initializer_list<wasm::Type> pop, std::initializer_list<wasm::Type> push);
+		void fSwapTypes(const detail::InstInfo& info);
 		void fPushTypes(std::initializer_list<wasm::Type> types);
 		void fPushTypes(const wasm::Prototype& prototype, bool params);
 
+	protected:
+		static wasm::ModuleInterface* fWriter(const wasm::Function& function);
+		wasm::SinkInterface* fInterface();
+		wasm::Variable fParam(uint32_t index);
+
+		/* validate the instruction and update the type stack, without passing it to the sink-interface */
+		void fAdd(const wasm::InstSimple& inst);
+		void fAdd(const wasm::InstConst& inst);
+		void fAdd(const wasm::InstOperand& inst);
+		void fAdd(const wasm::InstWidth& inst);
+		void fAdd(const wasm::InstMemory& inst);
+		void fAdd(const wasm::InstTable& inst);
+		void fAdd(const wasm::InstLocal& inst);
+		void fAdd(const wasm::InstGlobal& inst);
+		void fAdd(const wasm::InstFunction& inst);
+		void fAdd(const wasm::InstIndirect& inst);
+		void fAdd(const wasm::InstBranch& inst);
+
+		/* validate the batch of instructions and pass them on (if any instruction fails, the validated prefix is passed on) */
+		template <class Forward>
+		void fAdd(std::span<const wasm::InstAny> insts, Forward forward) {
+			size_t count = 0;
+			try {
+				for (; count < insts.size(); ++count)
+					detail::VisitInst(insts[count], [this](const auto& inst) { fAdd(inst); });
+			}
+			catch (const wasm::Exception&) {
+				if (count > 0)
+					forward(insts.first(count));
+				throw;
+			}
+			forward(insts);
+		}
+
 	public:
 		wasm::Variable param(uint32_t index);
 		wasm::Variable local(wasm::Type type, std::u8string_view id = {});
@@ -171,6 +234,101 @@ namespace wasm {
 		void operator[](const wasm::InstFunction& inst);
 		void operator[](const wasm::InstIndirect& inst);
 		void operator[](const wasm::InstBranch& inst);
+		void operator[](std::span<const wasm::InstAny> insts);
+		void operator[](std::initializer_list<wasm::InstAny> insts);
+	};
+
+	/* sink, which is statically bound to the given sink-implementation (such as wasm::binary::Sink), and thereby passes
+	*	the validated instructions to the writer without virtual dispatch (throws, if the module uses a different writer) */
+	template <class Interface>
+	class BasicSink final : public wasm::Sink {
+	private:
+		Interface* pWriter = 0;
+
+	public:
+		BasicSink(const wasm::Function& function) : wasm::Sink{ BasicSink::fValidate(function) } {
+			pWriter = static_cast<Interface*>(fInterface());
+		}
+		BasicSink(const wasm::Function& function, const wasm::SinkOptions& options) : wasm::Sink{ BasicSink::fValidate(function, options), options } {
+			pWriter = static_cast<Interface*>(fInterface());
+		}
+
+	private:
+		static const wasm::Function& fValidate(const wasm::Function& function, const wasm::SinkOptions& options = {}) {
+			/* check the writer and options before the function is bound, as it could otherwise not be sunken anymore (invalid functions are rejected by the sink) */
+			if (function.valid() && dynamic_cast<typename Interface::Writer*>(Sink::fWriter(function)) == 0)
+				throw wasm::Exception{ "Sink is not bound to a module of the given writer type" };
+			if (options.coalesce || options.simplify)
+				throw wasm::Exception{ "Sink passes its instructions directly to the writer and can therefore neither coalesce nor simplify its body" };
+			return function;
+		}
+
+	public:
+		void operator[](const wasm::InstSimple& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstConst& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstOperand& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstWidth& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstMemory& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstTable& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstLocal& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstParam& inst) {
+			switch (inst.type) {
+			case wasm::InstParam::Type::get:
+				operator[](wasm::InstLocal{ wasm::InstLocal::Type::get, fParam(inst.index) });
+				break;
+			case wasm::InstParam::Type::set:
+				operator[](wasm::InstLocal{ wasm::InstLocal::Type::set, fParam(inst.index) });
+				break;
+			case wasm::InstParam::Type::tee:
+				operator[](wasm::InstLocal{ wasm::InstLocal::Type::tee, fParam(inst.index) });
+				break;
+			default:
+				throw wasm::Exception{ "Unknown wasm::InstParam type [", size_t(inst.type), "] encountered" };
+			}
+		}
+		void operator[](const wasm::InstGlobal& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstFunction& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstIndirect& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](const wasm::InstBranch& inst) {
+			fAdd(inst);
+			pWriter->Interface::addInst(inst);
+		}
+		void operator[](std::span<const wasm::InstAny> insts) {
+			fAdd(insts, [this](std::span<const wasm::InstAny> valid) { pWriter->Interface::addInsts(valid); });
+		}
+		void operator[](std::initializer_list<wasm::InstAny> insts) {
+			operator[](std::span<const wasm::InstAny>{ insts.begin(), insts.size() });
+		}
 	};
 
 	namespace detail {
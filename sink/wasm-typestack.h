@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "../wasm-common.h"
+
+#include <memory>
+#include <cstring>
+
+namespace wasm::detail {
+	/* stack of value-types, which keeps the first types inline and only allocates
+	*	once it grows deeper (types are single bytes, and can therefore be compared as memory) */
+	class TypeStack {
+	public:
+		static constexpr size_t InlineCapacity = 64;
+
+	private:
+		wasm::Type pInline[TypeStack::InlineCapacity] = {};
+		std::unique_ptr<wasm::Type[]> pHeap;
+		wasm::Type* pData = pInline;
+		size_t pSize = 0;
+		size_t pCapacity = TypeStack::InlineCapacity;
+
+	public:
+		TypeStack() = default;
+		TypeStack(detail::TypeStack&&) = delete;
+		TypeStack(const detail::TypeStack&) = delete;
+
+	private:
+		void fGrow(size_t size) {
+			size_t capacity = std::max<size_t>(size, pCapacity * 2);
+
+			/* move the types to the new buffer (the inline buffer is never released) */
+			std::unique_ptr<wasm::Type[]> heap = std::make_unique_for_overwrite<wasm::Type[]>(capacity);
+			std::memcpy(heap.get(), pData, pSize);
+			pHeap = std::move(heap);
+			pData = pHeap.get();
+			pCapacity = capacity;
+		}
+
+	public:
+		size_t size() const {
+			return pSize;
+		}
+		const wasm::Type* begin() const {
+			return pData;
+		}
+		const wasm::Type* end() const {
+			return pData + pSize;
+		}
+		wasm::Type back() const {
+			return pData[pSize - 1];
+		}
+		void push(wasm::Type type) {
+			if (pSize == pCapacity)
+				fGrow(pSize + 1);
+			pData[pSize++] = type;
+		}
+		void push(std::span<const wasm::Type> types) {
+			/* empty spans might not reference any memory, which must not be passed to memcpy */
+			if (types.empty())
+				return;
+			if (pSize + types.size() > pCapacity)
+				fGrow(pSize + types.size());
+			std::memcpy(pData + pSize, types.data(), types.size());
+			pSize += types.size();
+		}
+		void truncate(size_t size) {
+			pSize = size;
+		}
+
+		/* check if the topmost types match the given types (expects the stack to contain at least as many types) */
+		bool top(std::span<const wasm::Type> types) const {
+			if (types.empty())
+				return true;
+			return (std::memcmp(pData + pSize - types.size(), types.data(), types.size()) == 0);
+		}
+	};
+}
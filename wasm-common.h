@@ -5,6 +5,7 @@
 #include <ustring/ustring.h>
 #include <cinttypes>
 #include <vector>
+#include <span>
 #include <unordered_set>
 #include <limits>
 #include <string>
@@ -15,9 +16,15 @@
 namespace wasm {
 	class Module;
 	class Sink;
+	class MemoryImage;
 	class SinkInterface;
 	class ModuleInterface;
 
+	namespace detail {
+		struct SinkCache;
+		class SinkRecorder;
+	}
+
 	/* exception thrown when using wasm module/instructions/sinks in unsupported ways */
 	struct Exception : public str::ch::BuildException {
 		template <class... Args>
@@ -68,6 +75,63 @@ namespace wasm {
 		Param(std::u8string id, wasm::Type type) : id{ id }, type{ type } {}
 	};
 
+	/* list of types, which only references the types of the initializer-list, vector, or span it has been
+	*	constructed from (used to pass type-lists without copying them, and must therefore not be stored) */
+	class TypeList {
+	private:
+		std::span<const wasm::Type> pTypes;
+
+	public:
+		constexpr TypeList() = default;
+		constexpr TypeList(std::initializer_list<wasm::Type> types) : pTypes{ types.begin(), types.size() } {}
+		constexpr TypeList(const std::vector<wasm::Type>& types) : pTypes{ types } {}
+		constexpr TypeList(std::span<const wasm::Type> types) : pTypes{ types } {}
+
+	public:
+		constexpr operator std::span<const wasm::Type>() const {
+			return pTypes;
+		}
+		constexpr std::span<const wasm::Type> types() const {
+			return pTypes;
+		}
+		constexpr size_t size() const {
+			return pTypes.size();
+		}
+		constexpr bool empty() const {
+			return pTypes.empty();
+		}
+		constexpr const wasm::Type* begin() const {
+			return pTypes.data();
+		}
+		constexpr const wasm::Type* end() const {
+			return pTypes.data() + pTypes.size();
+		}
+		constexpr wasm::Type operator[](size_t index) const {
+			return pTypes[index];
+		}
+	};
+
+	/* options of a single sink (constructed with designated initializers, such as { .trusted = true }) */
+	struct SinkOptions {
+		/* skip all validation and type checking of the instructions */
+		bool trusted = false;
+
+		/* record the body and merge non-interfering locals of the same type, once the sink is closed */
+		bool coalesce = false;
+
+		/* record the body and simplify its control-flow, once the sink is closed */
+		bool simplify = false;
+	};
+
+	/* options of a module (constructed with designated initializers, such as { .concurrent = true }) */
+	struct ModuleOptions {
+		/* create all sinks, which are not given explicit options, as trusted */
+		bool trustedSinks = false;
+
+		/* allow sinks of distinct functions to be filled on multiple threads at the same time */
+		bool concurrent = false;
+	};
+
 	/* limit used by memories and tables */
 	struct Limit {
 		uint32_t min = std::numeric_limits<uint32_t>::max();
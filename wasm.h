@@ -3,9 +3,11 @@
 #pragma once
 
 #include "objects/wasm-module.h"
+#include "objects/wasm-image.h"
 #include "sink/wasm-sink.h"
 #include "inst/wasm-instlist.h"
 
 #include "writer/binary-writer.h"
+#include "writer/opt-writer.h"
 #include "writer/split-writer.h"
 #include "writer/text-writer.h"
@@ -7,4 +7,5 @@
 
 namespace wasm {
 	using BinaryWriter = binary::Module;
+	using BinarySink = wasm::BasicSink<binary::Sink>;
 }
@@ -2,12 +2,6 @@
 /* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
 #include "binary-base.h"
 
-uint32_t wasm::binary::CountUInt(uint64_t value) {
-	uint32_t count = 1;
-	while ((value >>= 7) != 0)
-		++count;
-	return count;
-}
 void wasm::binary::WriteInt32(std::vector<uint8_t>& buffer, uint32_t value) {
 	binary::WriteSInt(buffer, int32_t(value));
 }
@@ -15,6 +9,12 @@ void wasm::binary::WriteInt64(std::vector<uint8_t>& buffer, uint64_t value) {
 	binary::WriteSInt(buffer, int64_t(value));
 }
 void wasm::binary::WriteUInt(std::vector<uint8_t>& buffer, uint64_t value) {
+	/* single values are appended byte-wise, as the vector cannot be written to beyond its size without clearing the memory
+	*	first, which outweighs the gain for short encodings (the sinks store their immediates into pre-reserved chunks instead) */
+	if (value < 0x80) {
+		buffer.push_back(uint8_t(value));
+		return;
+	}
 	do {
 		uint8_t byte = uint8_t(value & 0x7f);
 		if ((value >>= 7) != 0)
@@ -23,6 +23,10 @@ void wasm::binary::WriteUInt(std::vector<uint8_t>& buffer, uint64_t value) {
 	} while (value != 0);
 }
 void wasm::binary::WriteSInt(std::vector<uint8_t>& buffer, int64_t value) {
+	if (value >= -0x40 && value < 0x40) {
+		buffer.push_back(uint8_t(value & 0x7f));
+		return;
+	}
 	bool negative = (value < 0);
 	uint64_t lastValue = (negative ? uint64_t(-1) : 0);
 	uint8_t upperBit = (negative ? 0x40 : 0x00);
@@ -37,6 +41,9 @@ void wasm::binary::WriteSInt(std::vector<uint8_t>& buffer, int64_t value) {
 		}
 	}
 }
+void wasm::binary::WriteUInts(std::vector<uint8_t>& buffer, const uint32_t* values, size_t count) {
+	binary::WriteUInts(buffer, count, [&](size_t i) { return values[i]; });
+}
 void wasm::binary::WriteFloat(std::vector<uint8_t>& buffer, float value) {
 	const uint8_t* data = reinterpret_cast<const uint8_t*>(&value);
 	buffer.insert(buffer.end(), data, data + sizeof(float));
@@ -5,6 +5,12 @@
 #include <ustring/ustring.h>
 #include <algorithm>
 #include <vector>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <memory>
+#include <thread>
+#include <filesystem>
 
 #include "../../objects/wasm-module.h"
 #include "../../sink/wasm-sink.h"
@@ -14,11 +20,65 @@ namespace wasm::binary {
 	class Module;
 	class Sink;
 
-	uint32_t CountUInt(uint64_t value);
+	/* stream interface used to receive the finalized bytes of a module in order */
+	class StreamInterface {
+	public:
+		virtual void write(const uint8_t* data, size_t count) = 0;
+	};
+
+	/* maximum number of bytes a leb128 encoding of a 32-bit value can require, and the
+	*	number of bytes, which must be writable when storing a single value directly */
+	static constexpr size_t MaxLEB32 = 5;
+	static constexpr size_t StoreLEBSlack = 10;
+
+	/* count the bytes of the leb128 encodings (without branching on the value) */
+	inline uint32_t CountUInt(uint64_t value) {
+		return (uint32_t(std::bit_width(value | 1)) + 6) / 7;
+	}
+	inline uint32_t CountSInt(int64_t value) {
+		/* the encoding requires all significant bits and the sign bit */
+		return (uint32_t(std::bit_width(uint64_t(value < 0 ? ~value : value))) + 7) / 7;
+	}
+
+	/* store the leb128 encoding of count 7-bit groups of the value to out (requires StoreLEBSlack writable bytes), by
+	*	spreading up to 8 groups into a single 8-byte store, and return the number of bytes used by the encoding */
+	template <class Type>
+	inline uint32_t StoreGroups(uint8_t* out, Type value, uint32_t count) {
+		if (count <= 8) {
+			uint64_t v = uint64_t(value);
+			uint64_t word = (v & 0x7f) | ((v << 1) & 0x7f00) | ((v << 2) & 0x7f'0000) | ((v << 3) & 0x7f00'0000)
+				| ((v << 4) & 0x7f'0000'0000) | ((v << 5) & 0x7f00'0000'0000) | ((v << 6) & 0x7f'0000'0000'0000) | ((v << 7) & 0x7f00'0000'0000'0000);
+			word |= (0x8080'8080'8080'8080 & ((uint64_t(1) << (8 * (count - 1))) - 1));
+			std::memcpy(out, &word, sizeof(word));
+			return count;
+		}
+
+		/* write the large values byte by byte (the count is known, so there is no loop-carried dependency on the value) */
+		for (uint32_t i = 0; i + 1 < count; ++i)
+			out[i] = uint8_t((value >> (7 * i)) & 0x7f) | 0x80;
+		out[count - 1] = uint8_t((value >> (7 * (count - 1))) & 0x7f);
+		return count;
+	}
+	inline uint32_t StoreUInt(uint8_t* out, uint64_t value) {
+		if (value < 0x80) {
+			*out = uint8_t(value);
+			return 1;
+		}
+		return binary::StoreGroups(out, value, binary::CountUInt(value));
+	}
+	inline uint32_t StoreSInt(uint8_t* out, int64_t value) {
+		if (value >= -0x40 && value < 0x40) {
+			*out = uint8_t(value & 0x7f);
+			return 1;
+		}
+		return binary::StoreGroups(out, value, binary::CountSInt(value));
+	}
+
 	void WriteInt32(std::vector<uint8_t>& buffer, uint32_t value);
 	void WriteInt64(std::vector<uint8_t>& buffer, uint64_t value);
 	void WriteUInt(std::vector<uint8_t>& buffer, uint64_t value);
 	void WriteSInt(std::vector<uint8_t>& buffer, int64_t value);
+	void WriteUInts(std::vector<uint8_t>& buffer, const uint32_t* values, size_t count);
 	void WriteFloat(std::vector<uint8_t>& buffer, float value);
 	void WriteDouble(std::vector<uint8_t>& buffer, double value);
 	void WriteBytes(std::vector<uint8_t>& buffer, std::initializer_list<uint8_t> bytes);
@@ -27,4 +87,17 @@ namespace wasm::binary {
 	void WriteString(std::vector<uint8_t>& buffer, std::u8string_view str);
 	void WriteLimit(std::vector<uint8_t>& buffer, const wasm::Limit& limit);
 	void WriteValue(std::vector<uint8_t>& buffer, const wasm::Value& value);
+
+	/* write the count unsigned 32-bit values, fetched by fetch(index), with a single reservation for the entire list */
+	template <class FnType>
+	void WriteUInts(std::vector<uint8_t>& buffer, size_t count, FnType fetch) {
+		size_t size = buffer.size();
+		buffer.resize(size + count * binary::MaxLEB32 + binary::StoreLEBSlack);
+
+		/* encode the values directly into the reserved space and drop the unused remainder */
+		uint8_t* out = buffer.data() + size;
+		for (size_t i = 0; i < count; ++i)
+			out += binary::StoreUInt(out, uint32_t(fetch(i)));
+		buffer.resize(size_t(out - buffer.data()));
+	}
 }
@@ -3,6 +3,19 @@
 #include "binary-module.h"
 #include "binary-sink.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <cstdio>
+#endif
+
+wasm::binary::Module::Module(binary::StreamInterface* stream) : pStream{ stream } {}
+wasm::binary::Module::Module(const std::filesystem::path& path, uint32_t threads) : pPath{ path }, pThreads{ threads } {}
+wasm::binary::Module::~Module() = default;
+
 void wasm::binary::Module::fWriteImport(const std::u8string& importModule, std::u8string_view id, uint8_t type) {
 	binary::WriteString(pImport.buffer, importModule);
 	binary::WriteString(pImport.buffer, id);
@@ -14,72 +27,329 @@ void wasm::binary::Module::fWriteExport(std::u8string_view id, uint8_t type) {
 	pExport.buffer.push_back(type);
 	++pExport.count;
 }
-void wasm::binary::Module::fWriteSection(const Section& section, bool placeCount, uint8_t id) {
-	if (section.count == 0)
+void wasm::binary::Module::fWrite(const uint8_t* data, size_t count) {
+	if (count == 0)
+		return;
+
+	/* either pass the bytes directly to the stream or reference them as next segment of the output */
+	if (pStream != 0)
+		pStream->write(data, count);
+	else
+		pSegments.push_back({ data, count });
+}
+void wasm::binary::Module::fWriteHeader(std::vector<uint8_t>& header) {
+	if (pStream != 0) {
+		pStream->write(header.data(), header.size());
 		return;
+	}
 
-	/* write the id out */
-	pOutput.push_back(id);
+	/* keep the header alive for the segments (moving the vector does not move its data) */
+	pHeaders.push_back(std::move(header));
+	pSegments.push_back({ pHeaders.back().data(), pHeaders.back().size() });
+}
+void wasm::binary::Module::fWriteSection(Section& section, bool placeCount, uint8_t id) {
+	if (section.count == 0)
+		return;
 
-	/* write the byte-size and count out */
-	binary::WriteUInt(pOutput, uint64_t(section.buffer.size() + (placeCount ? binary::CountUInt(section.count) : 0)));
+	/* write the id, byte-size, and count out */
+	std::vector<uint8_t> header{ id };
+	binary::WriteUInt(header, uint64_t(section.buffer.size() + (placeCount ? binary::CountUInt(section.count) : 0)));
 	if (placeCount)
-		binary::WriteUInt(pOutput, section.count);
+		binary::WriteUInt(header, section.count);
+	fWriteHeader(header);
 
-	/* write the actual data out */
-	pOutput.insert(pOutput.end(), section.buffer.begin(), section.buffer.end());
+	/* write the actual data out and release it, if it has been streamed, as it will not be needed anymore */
+	fWrite(section.buffer.data(), section.buffer.size());
+	if (pStream != 0)
+		section.buffer = std::vector<uint8_t>{};
 }
-void wasm::binary::Module::fWriteSection(const Deferred& section, bool placeSlotSize, uint8_t id) {
+void wasm::binary::Module::fWriteSection(Deferred& section, uint8_t id) {
 	if (section.data.empty())
 		return;
 
-	/* write the id out */
-	pOutput.push_back(id);
-
 	/* compute the overall size */
 	uint32_t size = 0;
 	for (size_t i = 0; i < section.data.size(); ++i)
-		size += uint32_t(section.data[i].size()) + (placeSlotSize ? binary::CountUInt(section.data[i].size()) : 0);
+		size += uint32_t(section.data[i].size());
 
-	/* write the byte-size and count out */
-	binary::WriteUInt(pOutput, uint64_t(size + binary::CountUInt(section.data.size())));
-	binary::WriteUInt(pOutput, section.data.size());
+	/* write the id, byte-size, and count out */
+	std::vector<uint8_t> header{ id };
+	binary::WriteUInt(header, uint64_t(size + binary::CountUInt(section.data.size())));
+	binary::WriteUInt(header, section.data.size());
+	fWriteHeader(header);
 
-	/* write the actual data out */
+	/* write the actual data out and release each streamed slot as soon as it has been written */
 	for (size_t i = 0; i < section.data.size(); ++i) {
-		if (placeSlotSize)
-			binary::WriteUInt(pOutput, section.data[i].size());
-		pOutput.insert(pOutput.end(), section.data[i].begin(), section.data[i].end());
+		fWrite(section.data[i].data(), section.data[i].size());
+		if (pStream != 0)
+			section.data[i] = std::vector<uint8_t>{};
+	}
+}
+void wasm::binary::Module::fWriteSection(Code& section, uint8_t id) {
+	if (section.data.empty())
+		return;
+
+	/* compute the overall size (each body already contains its size-prefix) */
+	uint32_t size = 0;
+	for (size_t i = 0; i < section.data.size(); ++i)
+		size += uint32_t(section.data[i].size());
+
+	/* write the id, byte-size, and count out */
+	std::vector<uint8_t> header{ id };
+	binary::WriteUInt(header, uint64_t(size + binary::CountUInt(section.data.size())));
+	binary::WriteUInt(header, section.data.size());
+	fWriteHeader(header);
+
+	/* write the bodies out, and combine the bodies, which are adjacent within their chunks, into single segments */
+	for (size_t i = 0; i < section.data.size();) {
+		const uint8_t* begin = section.data[i].data();
+		const uint8_t* end = begin + section.data[i].size();
+		while (++i < section.data.size() && section.data[i].data() == end)
+			end += section.data[i].size();
+		fWrite(begin, end - begin);
+	}
+
+	/* release the streamed bodies, as they have been written */
+	if (pStream != 0)
+		section = {};
+}
+void wasm::binary::Module::fWriteSection(Data& section, uint8_t id) {
+	if (section.count == 0)
+		return;
+
+	/* write the id, byte-size, and count out */
+	std::vector<uint8_t> header{ id };
+	binary::WriteUInt(header, uint64_t(section.buffer.size() + section.borrowedSize + binary::CountUInt(section.count)));
+	binary::WriteUInt(header, section.count);
+	fWriteHeader(header);
+
+	/* write the owned data out with the borrowed data spliced in at their positions */
+	size_t written = 0;
+	for (const auto& [position, data] : section.borrowed) {
+		fWrite(section.buffer.data() + written, position - written);
+		fWrite(data.data(), data.size());
+		written = position;
+	}
+	fWrite(section.buffer.data() + written, section.buffer.size() - written);
+
+	/* release the owned data, if it has been streamed, as it will not be needed anymore */
+	if (pStream != 0)
+		section = Data{};
+}
+
+void wasm::binary::Module::fAssemble(uint8_t* output, size_t total, uint32_t threads) const {
+	/* compute the output offset of each segment (with the total size as last entry) */
+	std::vector<size_t> offsets(pSegments.size() + 1, 0);
+	for (size_t i = 0; i < pSegments.size(); ++i)
+		offsets[i + 1] = offsets[i] + pSegments[i].size();
+
+	/* copy the byte-range [begin, end) of the output (which may start or end within a segment) */
+	auto copy = [&](size_t begin, size_t end) {
+		size_t i = size_t(std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin()) - 1;
+		for (; begin < end; ++i) {
+			size_t count = std::min(offsets[i + 1], end) - begin;
+			std::memcpy(output + begin, pSegments[i].data() + (begin - offsets[i]), count);
+			begin += count;
+		}
+	};
+
+	/* only split the assembly across multiple threads, if there is enough data to amortize them */
+	static constexpr size_t MinBytesPerThread = 1024 * 1024;
+	size_t used = std::max<size_t>(1, std::min<size_t>(threads, total / MinBytesPerThread));
+	if (used <= 1) {
+		copy(0, total);
+		return;
+	}
+
+	/* split the output into evenly sized byte-ranges (the calling thread copies the last range) */
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i + 1 < used; ++i)
+		workers.emplace_back(copy, (total * i) / used, (total * (i + 1)) / used);
+	copy((total * (used - 1)) / used, total);
+	for (std::thread& worker : workers)
+		worker.join();
+}
+void wasm::binary::Module::fAddBody(uint32_t index, const std::vector<uint8_t>& header, const std::vector<uint8_t>& code) {
+	/* compute the size of the body (including the closing instruction-byte) and the size-prefix */
+	uint8_t prefix[binary::StoreLEBSlack];
+	size_t size = header.size() + code.size() + 1;
+	uint32_t count = binary::StoreUInt(prefix, size);
+
+	/* allocate a new chunk, if the body does not fit into the remaining capacity of the current chunk */
+	if (pCode.arena.empty() || pCode.arena.back().capacity() - pCode.arena.back().size() < count + size)
+		pCode.arena.emplace_back().reserve(std::max<size_t>(Module::ArenaChunkSize, count + size));
+	std::vector<uint8_t>& chunk = pCode.arena.back();
+	size_t offset = chunk.size();
+
+	/* copy the body into the chunk (will not reallocate it) */
+	chunk.insert(chunk.end(), prefix, prefix + count);
+	chunk.insert(chunk.end(), header.begin(), header.end());
+	chunk.insert(chunk.end(), code.begin(), code.end());
+	chunk.push_back(0x0b);
+	pCode.data[index] = { chunk.data() + offset, count + size };
+}
+void wasm::binary::Module::fDeduplicate() {
+	std::unordered_multimap<size_t, uint32_t> canonical;
+	std::vector<uint8_t> header{ 0x00 }, code;
+
+	/* visit the bodies in order of their functions, such that the first function of all functions with the same prototype
+	*	and body is canonical, independent of the order in which the sinks have been closed (the size-prefixes are included) */
+	for (uint32_t i = 0; i < pCode.data.size(); ++i) {
+		std::span<const uint8_t> body = pCode.data[i];
+		size_t hash = std::hash<std::string_view>{}(std::string_view{ reinterpret_cast<const char*>(body.data()), body.size() });
+		hash ^= size_t(pCode.prototypes[i].index()) * 0x9e3779b9;
+
+		/* lookup a canonical function with the same prototype and body or register this function as canonical */
+		auto [begin, end] = canonical.equal_range(hash);
+		auto it = std::find_if(begin, end, [&](const auto& entry) {
+			return (pCode.prototypes[entry.second].index() == pCode.prototypes[i].index() && std::ranges::equal(pCode.data[entry.second], body));
+			});
+		if (it == end) {
+			canonical.insert({ hash, i });
+			continue;
+		}
+
+		/* construct the forwarding stub, which passes all parameters to the canonical function, and
+		*	only replace the body, if the stub is smaller (the function itself keeps its index) */
+		code.clear();
+		uint32_t params = uint32_t(pCode.prototypes[i].parameter().size());
+		for (uint32_t j = 0; j < params; ++j) {
+			code.push_back(0x20);
+			binary::WriteUInt(code, j);
+		}
+		code.push_back(0x10);
+		binary::WriteUInt(code, it->second + pCode.indexOffset);
+		size_t size = header.size() + code.size() + 1;
+		if (binary::CountUInt(size) + size < body.size())
+			fAddBody(i, header, code);
 	}
 }
+void wasm::binary::Module::fWriteFile() {
+	size_t total = 0;
+	for (const std::span<const uint8_t>& segment : pSegments)
+		total += segment.size();
+
+#if defined(__unix__) || defined(__APPLE__)
+	/* size the file once and assemble the segments directly into its mapping (the kernel writes it back asynchronously) */
+	int file = ::open(pPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		throw wasm::Exception{ "Failed to open file [", pPath.u8string(), "] for the binary-writer output" };
 
-const std::vector<uint8_t>& wasm::binary::Module::output() const {
-	if (pOutput.empty())
+	/* allocate the blocks of the file up front, as writing to a sparse mapping on a full disk raises SIGBUS instead of
+	*	failing (falls back to only resizing the file, if the platform or file-system does not support the allocation) */
+#if defined(__APPLE__)
+	int error = (::ftruncate(file, off_t(total)) == 0 ? 0 : errno);
+#else
+	int error = ::posix_fallocate(file, 0, off_t(total));
+	if (error == EINVAL || error == EOPNOTSUPP)
+		error = (::ftruncate(file, off_t(total)) == 0 ? 0 : errno);
+#endif
+	if (error != 0) {
+		::close(file);
+		throw wasm::Exception{ "Failed to allocate [", total, "] bytes in file [", pPath.u8string(), "] for the binary-writer output" };
+	}
+	void* mapping = ::mmap(0, total, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	::close(file);
+	if (mapping == MAP_FAILED)
+		throw wasm::Exception{ "Failed to map file [", pPath.u8string(), "] for the binary-writer output" };
+	fAssemble(static_cast<uint8_t*>(mapping), total, pThreads);
+	if (::munmap(mapping, total) != 0)
+		throw wasm::Exception{ "Failed to unmap file [", pPath.u8string(), "] for the binary-writer output" };
+#else
+	/* fall back to writing the segments out in order */
+	std::FILE* file = std::fopen(pPath.string().c_str(), "wb");
+	if (file == 0)
+		throw wasm::Exception{ "Failed to open file [", pPath.u8string(), "] for the binary-writer output" };
+	for (const std::span<const uint8_t>& segment : pSegments) {
+		if (std::fwrite(segment.data(), 1, segment.size(), file) != segment.size()) {
+			std::fclose(file);
+			throw wasm::Exception{ "Failed to write to file [", pPath.u8string(), "] for the binary-writer output" };
+		}
+	}
+	std::fclose(file);
+#endif
+}
+
+void wasm::binary::Module::deduplicate(bool enabled) {
+	/* the prototypes and bodies are always collected, and are only deduplicated once the module is closed */
+	pDeduplicate = enabled;
+}
+const std::vector<std::span<const uint8_t>>& wasm::binary::Module::segments() const {
+	if (pStream != 0)
+		throw wasm::Exception{ "Cannot produce binary-writer module output for a module being written to a stream" };
+	if (!pPath.empty())
+		throw wasm::Exception{ "Cannot produce binary-writer module output for a module being written to a file" };
+	if (pSegments.empty())
 		throw wasm::Exception{ "Cannot produce binary-writer module output before the wrapping wasm::Module has been closed" };
+	return pSegments;
+}
+const std::vector<uint8_t>& wasm::binary::Module::output(uint32_t threads) const {
+	const std::vector<std::span<const uint8_t>>& segments = Module::segments();
+
+	/* concatenate the segments once on demand */
+	if (pOutput.empty()) {
+		size_t total = 0;
+		for (const std::span<const uint8_t>& segment : segments)
+			total += segment.size();
+		pOutput.resize(total);
+		fAssemble(pOutput.data(), total, threads);
+	}
 	return pOutput;
 }
 
 wasm::SinkInterface* wasm::binary::Module::sink(const wasm::Function& function) {
-	return new binary::Sink{ this, uint32_t(function.index() - pCode.indexOffset) };
+	uint32_t index = uint32_t(function.index() - pCode.indexOffset);
+
+	/* reuse an idle sink (and thereby its buffers) or allocate a new sink */
+	if (pIdle.empty())
+		return new binary::Sink{ this, index };
+	binary::Sink* sink = pIdle.back().release();
+	pIdle.pop_back();
+	sink->fSetup(index);
+	return sink;
 }
 void wasm::binary::Module::close(const wasm::Module& module) {
 	/* all globals will have been set and all functions will have been sunken and flushed by the wasm-framework */
 
+	/* replace the bodies of functions, which are identical to the body of a previous function, by forwarding stubs */
+	if (pDeduplicate)
+		fDeduplicate();
+
 	/* write the magic and version out */
-	binary::WriteBytes(pOutput, { 0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00 });
+	static constexpr uint8_t header[] = { 0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00 };
+	fWrite(header, sizeof(header));
 
-	/* write all sections out in order */
+	/* write all sections out in order (streamed sections are released once written, to keep the peak memory low,
+	*	otherwise the buffers are kept alive and referenced as segments of the output) */
 	fWriteSection(pPrototype, true, 0x01);
 	fWriteSection(pImport, true, 0x02);
 	fWriteSection(pFunction, true, 0x03);
-	fWriteSection(pTable, false, 0x04);
-	fWriteSection(pMemory, false, 0x05);
-	fWriteSection(pGlobal, false, 0x06);
+	fWriteSection(pTable, 0x04);
+	fWriteSection(pMemory, 0x05);
+	fWriteSection(pGlobal, 0x06);
 	fWriteSection(pExport, true, 0x07);
 	fWriteSection(pStart, false, 0x08);
 	fWriteSection(pElement, true, 0x09);
-	fWriteSection(pCode, true, 0x0a);
-	fWriteSection(pData, true, 0x0b);
+	fWriteSection(pCode, 0x0a);
+	fWriteSection(pData, 0x0b);
+
+	/* write the collected segments to the file and release all buffers, as they will not be needed anymore */
+	if (!pPath.empty()) {
+		fWriteFile();
+		pPrototype = {};
+		pFunction = {};
+		pImport = {};
+		pExport = {};
+		pTable = {};
+		pMemory = {};
+		pElement = {};
+		pData = {};
+		pStart = {};
+		pCode = {};
+		pGlobal = {};
+		pHeaders = {};
+		pSegments = {};
+	}
 }
 void wasm::binary::Module::addPrototype(const wasm::Prototype& prototype) {
 	const std::vector<wasm::Param>& params = prototype.parameter();
@@ -181,6 +451,7 @@ void wasm::binary::Module::addFunction(const wasm::Function& function) {
 		if (pCode.data.empty())
 			pCode.indexOffset = function.index();
 		pCode.data.emplace_back();
+		pCode.prototypes.push_back(function.prototype());
 		++pFunction.count;
 	}
 
@@ -200,7 +471,7 @@ void wasm::binary::Module::setStartup(const wasm::Function& function) {
 void wasm::binary::Module::setValue(const wasm::Global& global, const wasm::Value& value) {
 	wasm::binary::WriteValue(pGlobal.data[size_t(global.index() - pGlobal.indexOffset)], value);
 }
-void wasm::binary::Module::writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) {
+void wasm::binary::Module::writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) {
 	/* setup the next data entry */
 	++pData.count;
 	pData.buffer.push_back(0x02);
@@ -211,7 +482,14 @@ void wasm::binary::Module::writeData(const wasm::Memory& memory, const wasm::Val
 
 	/* write the data-vector out */
 	binary::WriteUInt(pData.buffer, count);
-	pData.buffer.insert(pData.buffer.end(), data, data + count);
+
+	/* either reference the borrowed data to be spliced in at the current position, or copy it */
+	if (borrowed && count > 0) {
+		pData.borrowed.push_back({ pData.buffer.size(), std::span<const uint8_t>{ data, count } });
+		pData.borrowedSize += count;
+	}
+	else
+		pData.buffer.insert(pData.buffer.end(), data, data + count);
 }
 void wasm::binary::Module::writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) {
 	/* check if the entire list of values consists of functions */
@@ -233,10 +511,8 @@ void wasm::binary::Module::writeElements(const wasm::Table& table, const wasm::V
 
 	/* write the element-vector out */
 	binary::WriteUInt(pElement.buffer, count);
-	if (allFunctions) {
-		for (uint32_t i = 0; i < count; ++i)
-			binary::WriteUInt(pElement.buffer, values[i].function().index());
-	}
+	if (allFunctions)
+		binary::WriteUInts(pElement.buffer, count, [&](size_t i) { return values[i].function().index(); });
 	else for (uint32_t i = 0; i < count; ++i)
 		binary::WriteValue(pElement.buffer, values[i]);
 }
@@ -16,6 +16,24 @@ namespace wasm::binary {
 			std::vector<std::vector<uint8_t>> data;
 			uint32_t indexOffset = 0;
 		};
+		struct Data {
+			std::vector<uint8_t> buffer;
+			std::vector<std::pair<size_t, std::span<const uint8_t>>> borrowed;
+			size_t borrowedSize = 0;
+			uint32_t count = 0;
+		};
+		struct Code {
+			std::vector<std::vector<uint8_t>> arena;
+			std::vector<std::unique_ptr<uint8_t[]>> chunks;
+			std::vector<std::span<const uint8_t>> data;
+			std::vector<wasm::Prototype> prototypes;
+			uint32_t indexOffset = 0;
+		};
+
+	private:
+		/* minimum size of the chunks of the code-arena, into which the forwarding stubs are written, and maximum size of the chunks, into
+		*	which the sinks write their bodies in place (chunks are never reallocated, as the bodies reference them) */
+		static constexpr size_t ArenaChunkSize = 0x100000;
 
 	private:
 		Section pPrototype;
@@ -25,20 +43,46 @@ namespace wasm::binary {
 		Deferred pTable;
 		Deferred pMemory;
 		Section pElement;
-		Section pData;
+		Data pData;
 		Section pStart;
-		Deferred pCode;
+		Code pCode;
 		Deferred pGlobal;
-		std::vector<uint8_t> pOutput;
+		std::vector<std::vector<uint8_t>> pHeaders;
+		std::vector<std::span<const uint8_t>> pSegments;
+		mutable std::vector<uint8_t> pOutput;
+		binary::StreamInterface* pStream = 0;
+		std::filesystem::path pPath;
+		uint32_t pThreads = 1;
+		bool pDeduplicate = false;
+		std::vector<std::unique_ptr<binary::Sink>> pIdle;
+
+	public:
+		Module() = default;
+		Module(binary::StreamInterface* stream);
+		Module(const std::filesystem::path& path, uint32_t threads = 1);
+		~Module();
 
 	private:
 		void fWriteImport(const std::u8string& importModule, std::u8string_view id, uint8_t type);
 		void fWriteExport(std::u8string_view id, uint8_t type);
-		void fWriteSection(const Section& section, bool placeCount, uint8_t id);
-		void fWriteSection(const Deferred& section, bool placeSlotSize, uint8_t id);
+		void fWrite(const uint8_t* data, size_t count);
+		void fWriteHeader(std::vector<uint8_t>& header);
+		void fWriteSection(Section& section, bool placeCount, uint8_t id);
+		void fWriteSection(Deferred& section, uint8_t id);
+		void fWriteSection(Code& section, uint8_t id);
+		void fWriteSection(Data& section, uint8_t id);
+		void fAssemble(uint8_t* output, size_t total, uint32_t threads) const;
+		void fWriteFile();
+		void fAddBody(uint32_t index, const std::vector<uint8_t>& header, const std::vector<uint8_t>& code);
+		void fDeduplicate();
 
 	public:
-		const std::vector<uint8_t>& output() const;
+		void deduplicate(bool enabled);
+
+		/* the segments and the output reference borrowed data written to the module, which must therefore
+		*	remain valid until the segments have been consumed or the output has been produced */
+		const std::vector<std::span<const uint8_t>>& segments() const;
+		const std::vector<uint8_t>& output(uint32_t threads = 1) const;
 
 	public:
 		wasm::SinkInterface* sink(const wasm::Function& function) override;
@@ -52,7 +96,7 @@ namespace wasm::binary {
 		void setTableLimit(const wasm::Table& table) override;
 		void setStartup(const wasm::Function& function) override;
 		void setValue(const wasm::Global& global, const wasm::Value& value) override;
-		void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) override;
+		void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) override;
 		void writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) override;
 	};
 }
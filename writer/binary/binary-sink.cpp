@@ -3,13 +3,68 @@
 #include "binary-module.h"
 #include "binary-sink.h"
 
-wasm::binary::Sink::Sink(binary::Module* module, uint32_t index) : pModule{ module }, pIndex{ index } {}
+wasm::binary::Sink::Sink(binary::Module* module, uint32_t index) : pModule{ module } {
+	fSetup(index);
+}
+
+void wasm::binary::Sink::fSetup(uint32_t index) {
+	/* reset the locals, but keep the capacity and the current chunk, as sinks are reused for further functions */
+	pIndex = index;
+	pLocals.clear();
+
+	/* reserve the space for the header of the next body behind the previous bodies of the chunk */
+	pBegin = pSize;
+	fReserve(Sink::ReservedHeader);
+	pSize += Sink::ReservedHeader;
+}
+uint8_t* wasm::binary::Sink::fReserve(size_t count) {
+	if (pCapacity - pSize >= count)
+		return pChunk.get() + pSize;
 
+	/* allocate the next larger chunk and move the open body over (the closed bodies remain in the
+	*	old chunk, as they are referenced by the module, which is why the chunk is never reallocated) */
+	size_t open = pSize - pBegin;
+	size_t capacity = std::max<size_t>(std::min<size_t>(std::max<size_t>(2 * pCapacity, Sink::InitialChunkSize), binary::Module::ArenaChunkSize), 2 * (open + count));
+	std::unique_ptr<uint8_t[]> chunk{ new uint8_t[capacity] };
+	if (open > 0)
+		std::memcpy(chunk.get(), pChunk.get() + pBegin, open);
+
+	/* keep the old chunk alive until the sink is closed, if it contains closed bodies (the module takes them over) */
+	if (pBegin > 0)
+		pRetired.push_back(std::move(pChunk));
+	pChunk = std::move(chunk);
+	pCapacity = capacity;
+	pBegin = 0;
+	pSize = open;
+	return pChunk.get() + pSize;
+}
 void wasm::binary::Sink::fPush(uint8_t byte) {
-	pCode.push_back(byte);
+	pChunk[pSize++] = byte;
 }
 void wasm::binary::Sink::fPush(std::initializer_list<uint8_t> bytes) {
-	pCode.insert(pCode.end(), bytes.begin(), bytes.end());
+	fPush(bytes.begin(), bytes.size());
+}
+void wasm::binary::Sink::fPush(const detail::InstInfo& info) {
+	fPush(info.code, info.codeSize);
+}
+void wasm::binary::Sink::fPush(const void* data, size_t count) {
+	std::memcpy(pChunk.get() + pSize, data, count);
+	pSize += count;
+}
+void wasm::binary::Sink::fPushUInt(uint64_t value) {
+	pSize += binary::StoreUInt(pChunk.get() + pSize, value);
+}
+void wasm::binary::Sink::fPushSInt(int64_t value) {
+	pSize += binary::StoreSInt(pChunk.get() + pSize, value);
+}
+template <class FnType>
+void wasm::binary::Sink::fPushUInts(size_t count, FnType fetch) {
+	/* encode the values directly into the chunk with a single reservation for the entire list,
+	*	which also restores the reservation of a whole instruction for the remaining immediates */
+	uint8_t* out = fReserve(count * binary::MaxLEB32 + Sink::MaxInstSize);
+	for (size_t i = 0; i < count; ++i)
+		out += binary::StoreUInt(out, uint32_t(fetch(i)));
+	pSize = size_t(out - pChunk.get());
 }
 void wasm::binary::Sink::fPushWidth(bool _32, uint8_t i32, uint8_t i64) {
 	fPush(_32 ? i32 : i64);
@@ -34,6 +89,8 @@ void wasm::binary::Sink::fPushSelect(wasm::OpType operand, uint8_t i32, uint8_t
 }
 
 void wasm::binary::Sink::pushScope(const wasm::Target& target) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the block-instruction out */
 	if (target.type() == wasm::ScopeType::conditional)
 		fPush(0x04);
@@ -48,32 +105,52 @@ void wasm::binary::Sink::pushScope(const wasm::Target& target) {
 	else if (target.prototype().parameter().empty() && target.prototype().result().size() == 1)
 		fPush(binary::GetType(target.prototype().result()[0]));
 	else
-		binary::WriteSInt(pCode, target.prototype().index());
+		fPushSInt(target.prototype().index());
 }
 void wasm::binary::Sink::popScope(wasm::ScopeType type) {
+	fReserve(Sink::MaxInstSize);
 	fPush(0x0b);
 }
 void wasm::binary::Sink::toggleConditional() {
+	fReserve(Sink::MaxInstSize);
 	fPush(0x05);
 }
 void wasm::binary::Sink::close(const wasm::Sink& sink) {
-	std::vector<uint8_t>& buffer = pModule->pCode.data[pIndex];
+	/* write the closing instruction-byte */
+	fReserve(Sink::MaxInstSize);
+	fPush(0x0b);
 
-	/* write the local data to the buffer */
-	binary::WriteUInt(buffer, pLocals.size());
+	/* construct the locals-header */
+	pHeader.clear();
+	binary::WriteUInt(pHeader, pLocals.size());
 	for (size_t i = 0; i < pLocals.size(); ++i) {
-		binary::WriteUInt(buffer, pLocals[i].count);
-		buffer.push_back(binary::GetType(pLocals[i].type));
+		binary::WriteUInt(pHeader, pLocals[i].count);
+		pHeader.push_back(binary::GetType(pLocals[i].type));
 	}
 
-	/* write the expression to the buffer */
-	buffer.insert(buffer.end(), pCode.begin(), pCode.end());
+	/* compute the size-prefix of the body and make room in front of the code, if the header exceeds the reserved space */
+	uint8_t prefix[binary::StoreLEBSlack];
+	size_t code = pSize - pBegin - Sink::ReservedHeader;
+	uint32_t count = binary::StoreUInt(prefix, pHeader.size() + code);
+	size_t header = count + pHeader.size();
+	if (header > Sink::ReservedHeader) {
+		fReserve(header - Sink::ReservedHeader);
+		std::memmove(pChunk.get() + pBegin + header, pChunk.get() + pBegin + Sink::ReservedHeader, code);
+		pSize += header - Sink::ReservedHeader;
+	}
 
-	/* write the closing instruction-byte */
-	buffer.push_back(0x0b);
+	/* back-patch the header directly in front of the code, such that the body is never copied */
+	uint8_t* body = pChunk.get() + pBegin + std::max<size_t>(header, Sink::ReservedHeader) - header;
+	std::memcpy(body, prefix, count);
+	std::memcpy(body + count, pHeader.data(), pHeader.size());
+	pModule->pCode.data[pIndex] = { body, header + code };
 
-	/* delete this sink (no reference will be held anymore) */
-	delete this;
+	/* pass the filled chunks and this sink back to the module, to keep the chunks alive and to reuse the
+	*	sink (no reference will be held anymore, and the sink continues to write behind this body) */
+	for (std::unique_ptr<uint8_t[]>& chunk : pRetired)
+		pModule->pCode.chunks.push_back(std::move(chunk));
+	pRetired.clear();
+	pModule->pIdle.emplace_back(this);
 }
 void wasm::binary::Sink::addLocal(const wasm::Variable& local) {
 	if (pLocals.empty() || pLocals.back().type != local.type())
@@ -85,266 +162,48 @@ void wasm::binary::Sink::addComment(std::u8string_view text) {
 	/* comments not supported for the binary format */
 }
 void wasm::binary::Sink::addInst(const wasm::InstSimple& inst) {
-	/* write the general instruction-type out */
-	switch (inst.type) {
-	case wasm::InstSimple::Type::drop:
-		fPush(0x1a);
-		break;
-	case wasm::InstSimple::Type::nop:
-		fPush(0x01);
-		break;
-	case wasm::InstSimple::Type::ret:
-		fPush(0x0f);
-		break;
-	case wasm::InstSimple::Type::unreachable:
-		fPush(0x00);
-		break;
-	case wasm::InstSimple::Type::select:
-		fPush(0x1b);
-		break;
-	case wasm::InstSimple::Type::selectRefFunction:
-		fPush({ 0x1c, 0x01, binary::GetType(wasm::Type::refFunction) });
-		break;
-	case wasm::InstSimple::Type::selectRefExtern:
-		fPush({ 0x1c, 0x01, binary::GetType(wasm::Type::refExtern) });
-		break;
-	case wasm::InstSimple::Type::refTestNull:
-		fPush(0xd1);
-		break;
-	case wasm::InstSimple::Type::refNullFunction:
-		fPush({ 0xd0, binary::GetType(wasm::Type::refFunction) });
-		break;
-	case wasm::InstSimple::Type::refNullExtern:
-		fPush({ 0xd0, binary::GetType(wasm::Type::refExtern) });
-		break;
-	case wasm::InstSimple::Type::expandIntSigned:
-		fPush(0xac);
-		break;
-	case wasm::InstSimple::Type::expandIntUnsigned:
-		fPush(0xad);
-		break;
-	case wasm::InstSimple::Type::shrinkInt:
-		fPush(0xa7);
-		break;
-	case wasm::InstSimple::Type::expandFloat:
-		fPush(0xbb);
-		break;
-	case wasm::InstSimple::Type::shrinkFloat:
-		fPush(0xb6);
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstSimple type [", size_t(inst.type), "] encountered" };
-	}
+	fReserve(Sink::MaxInstSize);
+
+	/* write the instruction out */
+	fPush(detail::GetInfo(inst));
 }
 void wasm::binary::Sink::addInst(const wasm::InstConst& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	if (std::holds_alternative<uint32_t>(inst.value)) {
 		fPush(0x41);
-		binary::WriteInt32(pCode, std::get<uint32_t>(inst.value));
+		fPushSInt(int32_t(std::get<uint32_t>(inst.value)));
 	}
 	else if (std::holds_alternative<uint64_t>(inst.value)) {
 		fPush(0x42);
-		binary::WriteInt64(pCode, std::get<uint64_t>(inst.value));
+		fPushSInt(int64_t(std::get<uint64_t>(inst.value)));
 	}
 	else if (std::holds_alternative<float>(inst.value)) {
 		fPush(0x43);
-		binary::WriteFloat(pCode, std::get<float>(inst.value));
+		fPush(&std::get<float>(inst.value), sizeof(float));
 	}
 	else if (std::holds_alternative<double>(inst.value)) {
 		fPush(0x44);
-		binary::WriteDouble(pCode, std::get<double>(inst.value));
+		fPush(&std::get<double>(inst.value), sizeof(double));
 	}
 	else
 		throw wasm::Exception{ "Unknown wasm::InstConst type encountered" };
 }
 void wasm::binary::Sink::addInst(const wasm::InstOperand& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the instruction out */
-	switch (inst.type) {
-	case wasm::InstOperand::Type::equal:
-		fPushSelect(inst.operand, 0x46, 0x51, 0x5b, 0x61);
-		break;
-	case wasm::InstOperand::Type::notEqual:
-		fPushSelect(inst.operand, 0x47, 0x52, 0x5c, 0x62);
-		break;
-	case wasm::InstOperand::Type::add:
-		fPushSelect(inst.operand, 0x6a, 0x7c, 0x92, 0xa0);
-		break;
-	case wasm::InstOperand::Type::sub:
-		fPushSelect(inst.operand, 0x6b, 0x7d, 0x93, 0xa1);
-		break;
-	case wasm::InstOperand::Type::mul:
-		fPushSelect(inst.operand, 0x6c, 0x7e, 0x94, 0xa2);
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstOperand type [", size_t(inst.type), "] encountered" };
-	}
+	fPush(detail::GetInfo(inst));
 }
 void wasm::binary::Sink::addInst(const wasm::InstWidth& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the instruction out */
-	switch (inst.type) {
-	case wasm::InstWidth::Type::equalZero:
-		fPushWidth(inst.width32, 0x45, 0x50);
-		break;
-	case wasm::InstWidth::Type::greater:
-		fPushWidth(inst.width32, 0x5e, 0x64);
-		break;
-	case wasm::InstWidth::Type::less:
-		fPushWidth(inst.width32, 0x5d, 0x63);
-		break;
-	case wasm::InstWidth::Type::greaterEqual:
-		fPushWidth(inst.width32, 0x60, 0x66);
-		break;
-	case wasm::InstWidth::Type::lessEqual:
-		fPushWidth(inst.width32, 0x5f, 0x65);
-		break;
-	case wasm::InstWidth::Type::greaterSigned:
-		fPushWidth(inst.width32, 0x4a, 0x55);
-		break;
-	case wasm::InstWidth::Type::greaterUnsigned:
-		fPushWidth(inst.width32, 0x4b, 0x56);
-		break;
-	case wasm::InstWidth::Type::lessSigned:
-		fPushWidth(inst.width32, 0x48, 0x53);
-		break;
-	case wasm::InstWidth::Type::lessUnsigned:
-		fPushWidth(inst.width32, 0x49, 0x54);
-		break;
-	case wasm::InstWidth::Type::greaterEqualSigned:
-		fPushWidth(inst.width32, 0x4e, 0x59);
-		break;
-	case wasm::InstWidth::Type::greaterEqualUnsigned:
-		fPushWidth(inst.width32, 0x4f, 0x5a);
-		break;
-	case wasm::InstWidth::Type::lessEqualSigned:
-		fPushWidth(inst.width32, 0x4c, 0x57);
-		break;
-	case wasm::InstWidth::Type::lessEqualUnsigned:
-		fPushWidth(inst.width32, 0x4d, 0x58);
-		break;
-	case wasm::InstWidth::Type::divSigned:
-		fPushWidth(inst.width32, 0x6d, 0x7f);
-		break;
-	case wasm::InstWidth::Type::divUnsigned:
-		fPushWidth(inst.width32, 0x6e, 0x80);
-		break;
-	case wasm::InstWidth::Type::modSigned:
-		fPushWidth(inst.width32, 0x6f, 0x81);
-		break;
-	case wasm::InstWidth::Type::modUnsigned:
-		fPushWidth(inst.width32, 0x70, 0x82);
-		break;
-	case wasm::InstWidth::Type::convertToF32Signed:
-		fPushWidth(inst.width32, 0xb2, 0xb4);
-		break;
-	case wasm::InstWidth::Type::convertToF32Unsigned:
-		fPushWidth(inst.width32, 0xb3, 0xb5);
-		break;
-	case wasm::InstWidth::Type::convertToF64Signed:
-		fPushWidth(inst.width32, 0xb7, 0xb9);
-		break;
-	case wasm::InstWidth::Type::convertToF64Unsigned:
-		fPushWidth(inst.width32, 0xb8, 0xba);
-		break;
-	case wasm::InstWidth::Type::convertFromF32SignedTrap:
-		fPushWidth(inst.width32, 0xa8, 0xae);
-		break;
-	case wasm::InstWidth::Type::convertFromF32UnsignedTrap:
-		fPushWidth(inst.width32, 0xa9, 0xaf);
-		break;
-	case wasm::InstWidth::Type::convertFromF64SignedTrap:
-		fPushWidth(inst.width32, 0xaa, 0xb0);
-		break;
-	case wasm::InstWidth::Type::convertFromF64UnsignedTrap:
-		fPushWidth(inst.width32, 0xab, 0xb1);
-		break;
-	case wasm::InstWidth::Type::convertFromF32SignedNoTrap:
-		fPush({ 0xfc, uint8_t(inst.width32 ? 0x00 : 0x04) });
-		break;
-	case wasm::InstWidth::Type::convertFromF32UnsignedNoTrap:
-		fPush({ 0xfc, uint8_t(inst.width32 ? 0x01 : 0x05) });
-		break;
-	case wasm::InstWidth::Type::convertFromF64SignedNoTrap:
-		fPush({ 0xfc, uint8_t(inst.width32 ? 0x02 : 0x06) });
-		break;
-	case wasm::InstWidth::Type::convertFromF64UnsignedNoTrap:
-		fPush({ 0xfc, uint8_t(inst.width32 ? 0x03 : 0x07) });
-		break;
-	case wasm::InstWidth::Type::reinterpretAsFloat:
-		fPushWidth(inst.width32, 0xbe, 0xbf);
-		break;
-	case wasm::InstWidth::Type::bitAnd:
-		fPushWidth(inst.width32, 0x71, 0x83);
-		break;
-	case wasm::InstWidth::Type::bitOr:
-		fPushWidth(inst.width32, 0x72, 0x84);
-		break;
-	case wasm::InstWidth::Type::bitXOr:
-		fPushWidth(inst.width32, 0x73, 0x85);
-		break;
-	case wasm::InstWidth::Type::bitShiftLeft:
-		fPushWidth(inst.width32, 0x74, 0x86);
-		break;
-	case wasm::InstWidth::Type::bitShiftRightSigned:
-		fPushWidth(inst.width32, 0x75, 0x87);
-		break;
-	case wasm::InstWidth::Type::bitShiftRightUnsigned:
-		fPushWidth(inst.width32, 0x76, 0x88);
-		break;
-	case wasm::InstWidth::Type::bitRotateLeft:
-		fPushWidth(inst.width32, 0x77, 0x89);
-		break;
-	case wasm::InstWidth::Type::bitRotateRight:
-		fPushWidth(inst.width32, 0x78, 0x8a);
-		break;
-	case wasm::InstWidth::Type::bitLeadingNulls:
-		fPushWidth(inst.width32, 0x67, 0x79);
-		break;
-	case wasm::InstWidth::Type::bitTrailingNulls:
-		fPushWidth(inst.width32, 0x68, 0x7a);
-		break;
-	case wasm::InstWidth::Type::bitSetCount:
-		fPushWidth(inst.width32, 0x69, 0x7b);
-		break;
-	case wasm::InstWidth::Type::floatDiv:
-		fPushWidth(inst.width32, 0x95, 0xa3);
-		break;
-	case wasm::InstWidth::Type::reinterpretAsInt:
-		fPushWidth(inst.width32, 0xbc, 0xbd);
-		break;
-	case wasm::InstWidth::Type::floatMin:
-		fPushWidth(inst.width32, 0x96, 0xa4);
-		break;
-	case wasm::InstWidth::Type::floatMax:
-		fPushWidth(inst.width32, 0x97, 0xa5);
-		break;
-	case wasm::InstWidth::Type::floatFloor:
-		fPushWidth(inst.width32, 0x8e, 0x9c);
-		break;
-	case wasm::InstWidth::Type::floatRound:
-		fPushWidth(inst.width32, 0x90, 0x9e);
-		break;
-	case wasm::InstWidth::Type::floatCeil:
-		fPushWidth(inst.width32, 0x8d, 0x9b);
-		break;
-	case wasm::InstWidth::Type::floatTruncate:
-		fPushWidth(inst.width32, 0x8f, 0x9d);
-		break;
-	case wasm::InstWidth::Type::floatAbsolute:
-		fPushWidth(inst.width32, 0x8b, 0x99);
-		break;
-	case wasm::InstWidth::Type::floatNegate:
-		fPushWidth(inst.width32, 0x8c, 0x9a);
-		break;
-	case wasm::InstWidth::Type::floatSquareRoot:
-		fPushWidth(inst.width32, 0x91, 0x9f);
-		break;
-	case wasm::InstWidth::Type::floatCopySign:
-		fPushWidth(inst.width32, 0x98, 0xa6);
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstWidth type [", size_t(inst.type), "] encountered" };
-	}
+	fPush(detail::GetInfo(inst));
 }
 void wasm::binary::Sink::addInst(const wasm::InstMemory& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	bool writeMemoryAndOffset = false;
 
 	/* write the general instruction opcode out */
@@ -395,20 +254,20 @@ void wasm::binary::Sink::addInst(const wasm::InstMemory& inst) {
 		break;
 	case wasm::InstMemory::Type::size:
 		fPush(0x3f);
-		binary::WriteUInt(pCode, inst.memory.index());
+		fPushUInt(inst.memory.index());
 		break;
 	case wasm::InstMemory::Type::grow:
 		fPush(0x40);
-		binary::WriteUInt(pCode, inst.memory.index());
+		fPushUInt(inst.memory.index());
 		break;
 	case wasm::InstMemory::Type::copy:
 		fPush({ 0xfc, 0x0a });
-		binary::WriteUInt(pCode, inst.destination.index());
-		binary::WriteUInt(pCode, inst.memory.index());
+		fPushUInt(inst.destination.index());
+		fPushUInt(inst.memory.index());
 		break;
 	case wasm::InstMemory::Type::fill:
 		fPush({ 0xfc, 0x0b });
-		binary::WriteUInt(pCode, inst.memory.index());
+		fPushUInt(inst.memory.index());
 		break;
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstMemory type [", size_t(inst.type), "] encountered" };
@@ -418,14 +277,16 @@ void wasm::binary::Sink::addInst(const wasm::InstMemory& inst) {
 	if (writeMemoryAndOffset) {
 		if (inst.memory.index() != 0) {
 			fPush(0x40);
-			binary::WriteUInt(pCode, inst.memory.index());
+			fPushUInt(inst.memory.index());
 		}
 		else
 			fPush(0x00);
-		binary::WriteUInt(pCode, inst.offset);
+		fPushUInt(inst.offset);
 	}
 }
 void wasm::binary::Sink::addInst(const wasm::InstTable& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the general instruction opcode out */
 	switch (inst.type) {
 	case wasm::InstTable::Type::get:
@@ -452,10 +313,12 @@ void wasm::binary::Sink::addInst(const wasm::InstTable& inst) {
 
 	/* write the table indices out (first index indicates destination) */
 	if (inst.type == wasm::InstTable::Type::copy)
-		binary::WriteUInt(pCode, inst.destination.index());
-	binary::WriteUInt(pCode, inst.table.index());
+		fPushUInt(inst.destination.index());
+	fPushUInt(inst.table.index());
 }
 void wasm::binary::Sink::addInst(const wasm::InstLocal& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the general instruction opcode out */
 	switch (inst.type) {
 	case wasm::InstLocal::Type::get:
@@ -472,9 +335,11 @@ void wasm::binary::Sink::addInst(const wasm::InstLocal& inst) {
 	}
 
 	/* write the local index out */
-	binary::WriteUInt(pCode, inst.variable.index());
+	fPushUInt(inst.variable.index());
 }
 void wasm::binary::Sink::addInst(const wasm::InstGlobal& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the general instruction opcode out */
 	switch (inst.type) {
 	case wasm::InstGlobal::Type::get:
@@ -488,9 +353,11 @@ void wasm::binary::Sink::addInst(const wasm::InstGlobal& inst) {
 	}
 
 	/* write the global index out */
-	binary::WriteUInt(pCode, inst.global.index());
+	fPushUInt(inst.global.index());
 }
 void wasm::binary::Sink::addInst(const wasm::InstFunction& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the general instruction opcode out */
 	switch (inst.type) {
 	case wasm::InstFunction::Type::refFunction:
@@ -507,9 +374,11 @@ void wasm::binary::Sink::addInst(const wasm::InstFunction& inst) {
 	}
 
 	/* write the function index out */
-	binary::WriteUInt(pCode, inst.function.index());
+	fPushUInt(inst.function.index());
 }
 void wasm::binary::Sink::addInst(const wasm::InstIndirect& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the general instruction opcode out */
 	switch (inst.type) {
 	case wasm::InstIndirect::Type::callNormal:
@@ -523,10 +392,12 @@ void wasm::binary::Sink::addInst(const wasm::InstIndirect& inst) {
 	}
 
 	/* write the type and table index out */
-	binary::WriteUInt(pCode, inst.prototype.index());
-	binary::WriteUInt(pCode, inst.table.index());
+	fPushUInt(inst.prototype.index());
+	fPushUInt(inst.table.index());
 }
 void wasm::binary::Sink::addInst(const wasm::InstBranch& inst) {
+	fReserve(Sink::MaxInstSize);
+
 	/* write the general instruction opcode out */
 	switch (inst.type) {
 	case wasm::InstBranch::Type::direct:
@@ -537,14 +408,25 @@ void wasm::binary::Sink::addInst(const wasm::InstBranch& inst) {
 		break;
 	case wasm::InstBranch::Type::table:
 		fPush(0x0e);
-		binary::WriteUInt(pCode, inst.list.size());
-		for (size_t i = 0; i < inst.list.size(); ++i)
-			binary::WriteUInt(pCode, inst.list.begin()[i].get().index());
+		if (inst.depths.empty()) {
+			std::span<const wasm::WTarget> targets = inst.targets();
+			fPushUInt(targets.size());
+			fPushUInts(targets.size(), [&](size_t i) { return targets[i].get().index(); });
+		}
+		else {
+			fPushUInt(inst.depths.size());
+			fPushUInts(inst.depths.size(), [&](size_t i) { return inst.depths[i]; });
+		}
 		break;
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstBranch type [", size_t(inst.type), "] encountered" };
 	}
 
 	/* write the target index out */
-	binary::WriteUInt(pCode, inst.target.index());
+	fPushUInt(inst.target.index());
+}
+void wasm::binary::Sink::addInsts(std::span<const wasm::InstAny> insts) {
+	/* encode the instructions without dispatching each one through the sink-interface */
+	for (const wasm::InstAny& inst : insts)
+		detail::VisitInst(inst, [this](const auto& value) { binary::Sink::addInst(value); });
 }
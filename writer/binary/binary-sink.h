@@ -7,6 +7,20 @@
 namespace wasm::binary {
 	class Sink final : public wasm::SinkInterface {
 		friend class binary::Module;
+	public:
+		/* module-interface, which creates sinks of this type (used by wasm::BasicSink to check the module) */
+		using Writer = binary::Module;
+
+	private:
+		/* number of bytes reserved in front of each body for the size-prefix and locals-header (back-patched on close),
+		*	and the size of the first chunk, into which the bodies are written (chunks grow up to the arena-chunk size) */
+		static constexpr size_t ReservedHeader = 16;
+		static constexpr size_t InitialChunkSize = 0x1000;
+
+		/* number of bytes reserved once per instruction, which covers the opcode and the immediates, such that
+		*	they can be stored without further checks (only the target-list of br_table reserves additional space) */
+		static constexpr size_t MaxInstSize = 3 + 2 * binary::MaxLEB32 + binary::StoreLEBSlack;
+
 	private:
 		struct Local {
 			uint32_t count = 0;
@@ -16,15 +30,28 @@ namespace wasm::binary {
 	private:
 		binary::Module* pModule = 0;
 		std::vector<Local> pLocals;
-		std::vector<uint8_t> pCode;
+		std::vector<uint8_t> pHeader;
+		std::vector<std::unique_ptr<uint8_t[]>> pRetired;
+		std::unique_ptr<uint8_t[]> pChunk;
+		size_t pCapacity = 0;
+		size_t pBegin = 0;
+		size_t pSize = 0;
 		uint32_t pIndex = 0;
 
 	private:
 		Sink(binary::Module* module, uint32_t index);
 
 	private:
+		void fSetup(uint32_t index);
+		uint8_t* fReserve(size_t count);
 		void fPush(uint8_t byte);
 		void fPush(std::initializer_list<uint8_t> bytes);
+		void fPush(const detail::InstInfo& info);
+		void fPush(const void* data, size_t count);
+		void fPushUInt(uint64_t value);
+		void fPushSInt(int64_t value);
+		template <class FnType>
+		void fPushUInts(size_t count, FnType fetch);
 		void fPushWidth(bool _32, uint8_t i32, uint8_t i64);
 		void fPushSelect(wasm::OpType operand, uint8_t i32, uint8_t i64, uint8_t f32, uint8_t f64);
 
@@ -46,5 +73,6 @@ namespace wasm::binary {
 		void addInst(const wasm::InstFunction& inst) override;
 		void addInst(const wasm::InstIndirect& inst) override;
 		void addInst(const wasm::InstBranch& inst) override;
+		void addInsts(std::span<const wasm::InstAny> insts) override;
 	};
 }
@@ -0,0 +1,10 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "opt/peephole-module.h"
+#include "opt/peephole-sink.h"
+#include "opt/folding-module.h"
+#include "opt/folding-sink.h"
+#include "opt/pruning-module.h"
+#include "opt/pruning-sink.h"
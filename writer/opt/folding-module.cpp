@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "folding-module.h"
+#include "folding-sink.h"
+
+wasm::opt::FoldingWriter::FoldingWriter(wasm::ModuleInterface* target) : Decorator{ target } {}
+wasm::opt::FoldingWriter::~FoldingWriter() = default;
+
+wasm::SinkInterface* wasm::opt::FoldingWriter::sink(const wasm::Function& function) {
+	return Decorator::fAcquire<opt::FoldingSink>(function);
+}
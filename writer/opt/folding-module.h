@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "opt-base.h"
+
+namespace wasm::opt {
+	/* module-decorator, which folds constant expressions and removes algebraic identities from the
+	*	instruction-stream of all functions, before passing it to the wrapped module-interface (all
+	*	other objects are passed through unchanged) */
+	class FoldingWriter final : public opt::Decorator {
+		friend class opt::FoldingSink;
+	public:
+		FoldingWriter(wasm::ModuleInterface* target);
+		~FoldingWriter();
+
+	public:
+		wasm::SinkInterface* sink(const wasm::Function& function) override;
+	};
+}
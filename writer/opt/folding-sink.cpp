@@ -0,0 +1,440 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "folding-module.h"
+#include "folding-sink.h"
+
+wasm::opt::FoldingSink::FoldingSink(opt::FoldingWriter* writer) : pWriter{ writer } {}
+
+template <class Int, class UInt>
+std::optional<wasm::InstConst> wasm::opt::FoldingSink::fTruncate(double value, bool saturate) {
+	/* the truncated value is representable, if it lies strictly between min-1 and max+1 (for 64-bit
+	*	integers, min-1 rounds to min itself, which is why min is checked separately) */
+	constexpr double Lower = double(std::numeric_limits<Int>::min());
+	const double upper = std::ldexp(1.0, std::numeric_limits<Int>::digits);
+	if ((value > Lower - 1.0 || value == Lower) && value < upper)
+		return wasm::InstConst{ UInt(Int(value)) };
+
+	/* trapping conversions must be left to the runtime */
+	if (!saturate)
+		return std::nullopt;
+	if (std::isnan(value))
+		return wasm::InstConst{ UInt(0) };
+	return wasm::InstConst{ UInt(value < 0 ? std::numeric_limits<Int>::min() : std::numeric_limits<Int>::max()) };
+}
+template <class Float>
+std::optional<wasm::InstConst> wasm::opt::FoldingSink::fFloat(Float value) {
+	/* nan-results are not folded, as their exact bit-pattern is not fully defined by the standard */
+	if (std::isnan(value))
+		return std::nullopt;
+	return wasm::InstConst{ value };
+}
+template <class Type>
+std::optional<wasm::InstConst> wasm::opt::FoldingSink::fEvaluate(wasm::InstOperand::Type type, Type a, Type b) {
+	auto result = [](Type value) -> std::optional<wasm::InstConst> {
+		if constexpr (std::is_floating_point_v<Type>)
+			return FoldingSink::fFloat<Type>(value);
+		else
+			return wasm::InstConst{ value };
+		};
+
+	switch (type) {
+	case wasm::InstOperand::Type::equal:
+		return wasm::InstConst{ uint32_t(a == b ? 1 : 0) };
+	case wasm::InstOperand::Type::notEqual:
+		return wasm::InstConst{ uint32_t(a != b ? 1 : 0) };
+	case wasm::InstOperand::Type::add:
+		return result(Type(a + b));
+	case wasm::InstOperand::Type::sub:
+		return result(Type(a - b));
+	case wasm::InstOperand::Type::mul:
+		return result(Type(a * b));
+	}
+	return std::nullopt;
+}
+template <class UInt, class SInt, class Float>
+std::optional<wasm::InstConst> wasm::opt::FoldingSink::fEvaluate(wasm::InstWidth::Type type, const wasm::InstConst* operands) {
+	constexpr UInt Bits = UInt(sizeof(UInt) * 8);
+	constexpr UInt SignBit = UInt(1) << (Bits - 1);
+	auto uint = [&](size_t index) -> UInt { return std::get<UInt>(operands[index].value); };
+	auto sint = [&](size_t index) -> SInt { return SInt(std::get<UInt>(operands[index].value)); };
+	auto real = [&](size_t index) -> Float { return std::get<Float>(operands[index].value); };
+	auto flag = [](bool value) -> std::optional<wasm::InstConst> { return wasm::InstConst{ uint32_t(value ? 1 : 0) }; };
+
+	switch (type) {
+	case wasm::InstWidth::Type::equalZero:
+		return flag(uint(0) == 0);
+	case wasm::InstWidth::Type::greater:
+		return flag(real(0) > real(1));
+	case wasm::InstWidth::Type::less:
+		return flag(real(0) < real(1));
+	case wasm::InstWidth::Type::greaterEqual:
+		return flag(real(0) >= real(1));
+	case wasm::InstWidth::Type::lessEqual:
+		return flag(real(0) <= real(1));
+	case wasm::InstWidth::Type::greaterSigned:
+		return flag(sint(0) > sint(1));
+	case wasm::InstWidth::Type::greaterUnsigned:
+		return flag(uint(0) > uint(1));
+	case wasm::InstWidth::Type::lessSigned:
+		return flag(sint(0) < sint(1));
+	case wasm::InstWidth::Type::lessUnsigned:
+		return flag(uint(0) < uint(1));
+	case wasm::InstWidth::Type::greaterEqualSigned:
+		return flag(sint(0) >= sint(1));
+	case wasm::InstWidth::Type::greaterEqualUnsigned:
+		return flag(uint(0) >= uint(1));
+	case wasm::InstWidth::Type::lessEqualSigned:
+		return flag(sint(0) <= sint(1));
+	case wasm::InstWidth::Type::lessEqualUnsigned:
+		return flag(uint(0) <= uint(1));
+
+	/* division by zero and the overflowing signed division trap (the overflowing remainder is defined as zero) */
+	case wasm::InstWidth::Type::divSigned:
+		if (uint(1) == 0 || (uint(0) == SignBit && sint(1) == -1))
+			return std::nullopt;
+		return wasm::InstConst{ UInt(sint(0) / sint(1)) };
+	case wasm::InstWidth::Type::divUnsigned:
+		if (uint(1) == 0)
+			return std::nullopt;
+		return wasm::InstConst{ UInt(uint(0) / uint(1)) };
+	case wasm::InstWidth::Type::modSigned:
+		if (uint(1) == 0)
+			return std::nullopt;
+		if (sint(1) == -1)
+			return wasm::InstConst{ UInt(0) };
+		return wasm::InstConst{ UInt(sint(0) % sint(1)) };
+	case wasm::InstWidth::Type::modUnsigned:
+		if (uint(1) == 0)
+			return std::nullopt;
+		return wasm::InstConst{ UInt(uint(0) % uint(1)) };
+
+	case wasm::InstWidth::Type::convertToF32Signed:
+		return wasm::InstConst{ float(sint(0)) };
+	case wasm::InstWidth::Type::convertToF32Unsigned:
+		return wasm::InstConst{ float(uint(0)) };
+	case wasm::InstWidth::Type::convertToF64Signed:
+		return wasm::InstConst{ double(sint(0)) };
+	case wasm::InstWidth::Type::convertToF64Unsigned:
+		return wasm::InstConst{ double(uint(0)) };
+	case wasm::InstWidth::Type::convertFromF32SignedTrap:
+		return FoldingSink::fTruncate<SInt, UInt>(std::get<float>(operands[0].value), false);
+	case wasm::InstWidth::Type::convertFromF32UnsignedTrap:
+		return FoldingSink::fTruncate<UInt, UInt>(std::get<float>(operands[0].value), false);
+	case wasm::InstWidth::Type::convertFromF64SignedTrap:
+		return FoldingSink::fTruncate<SInt, UInt>(std::get<double>(operands[0].value), false);
+	case wasm::InstWidth::Type::convertFromF64UnsignedTrap:
+		return FoldingSink::fTruncate<UInt, UInt>(std::get<double>(operands[0].value), false);
+	case wasm::InstWidth::Type::convertFromF32SignedNoTrap:
+		return FoldingSink::fTruncate<SInt, UInt>(std::get<float>(operands[0].value), true);
+	case wasm::InstWidth::Type::convertFromF32UnsignedNoTrap:
+		return FoldingSink::fTruncate<UInt, UInt>(std::get<float>(operands[0].value), true);
+	case wasm::InstWidth::Type::convertFromF64SignedNoTrap:
+		return FoldingSink::fTruncate<SInt, UInt>(std::get<double>(operands[0].value), true);
+	case wasm::InstWidth::Type::convertFromF64UnsignedNoTrap:
+		return FoldingSink::fTruncate<UInt, UInt>(std::get<double>(operands[0].value), true);
+	case wasm::InstWidth::Type::reinterpretAsFloat:
+		return FoldingSink::fFloat<Float>(std::bit_cast<Float>(uint(0)));
+	case wasm::InstWidth::Type::reinterpretAsInt:
+		return wasm::InstConst{ std::bit_cast<UInt>(real(0)) };
+
+	/* shift and rotation counts are taken modulo the bit-width */
+	case wasm::InstWidth::Type::bitAnd:
+		return wasm::InstConst{ UInt(uint(0) & uint(1)) };
+	case wasm::InstWidth::Type::bitOr:
+		return wasm::InstConst{ UInt(uint(0) | uint(1)) };
+	case wasm::InstWidth::Type::bitXOr:
+		return wasm::InstConst{ UInt(uint(0) ^ uint(1)) };
+	case wasm::InstWidth::Type::bitShiftLeft:
+		return wasm::InstConst{ UInt(uint(0) << (uint(1) % Bits)) };
+	case wasm::InstWidth::Type::bitShiftRightSigned:
+		return wasm::InstConst{ UInt(sint(0) >> (uint(1) % Bits)) };
+	case wasm::InstWidth::Type::bitShiftRightUnsigned:
+		return wasm::InstConst{ UInt(uint(0) >> (uint(1) % Bits)) };
+	case wasm::InstWidth::Type::bitRotateLeft:
+		return wasm::InstConst{ UInt(std::rotl(uint(0), int(uint(1) % Bits))) };
+	case wasm::InstWidth::Type::bitRotateRight:
+		return wasm::InstConst{ UInt(std::rotr(uint(0), int(uint(1) % Bits))) };
+	case wasm::InstWidth::Type::bitLeadingNulls:
+		return wasm::InstConst{ UInt(std::countl_zero(uint(0))) };
+	case wasm::InstWidth::Type::bitTrailingNulls:
+		return wasm::InstConst{ UInt(std::countr_zero(uint(0))) };
+	case wasm::InstWidth::Type::bitSetCount:
+		return wasm::InstConst{ UInt(std::popcount(uint(0))) };
+
+	/* min/max must order the zeros by their sign, and absolute/negate/copy-sign only affect the sign-bit */
+	case wasm::InstWidth::Type::floatDiv:
+		return FoldingSink::fFloat<Float>(real(0) / real(1));
+	case wasm::InstWidth::Type::floatMin:
+		if (std::isnan(real(0)) || std::isnan(real(1)))
+			return std::nullopt;
+		if (real(0) == real(1))
+			return wasm::InstConst{ std::signbit(real(0)) ? real(0) : real(1) };
+		return wasm::InstConst{ real(0) < real(1) ? real(0) : real(1) };
+	case wasm::InstWidth::Type::floatMax:
+		if (std::isnan(real(0)) || std::isnan(real(1)))
+			return std::nullopt;
+		if (real(0) == real(1))
+			return wasm::InstConst{ std::signbit(real(0)) ? real(1) : real(0) };
+		return wasm::InstConst{ real(0) > real(1) ? real(0) : real(1) };
+	case wasm::InstWidth::Type::floatFloor:
+		return FoldingSink::fFloat<Float>(std::floor(real(0)));
+	case wasm::InstWidth::Type::floatRound:
+		return FoldingSink::fFloat<Float>(std::nearbyint(real(0)));
+	case wasm::InstWidth::Type::floatCeil:
+		return FoldingSink::fFloat<Float>(std::ceil(real(0)));
+	case wasm::InstWidth::Type::floatTruncate:
+		return FoldingSink::fFloat<Float>(std::trunc(real(0)));
+	case wasm::InstWidth::Type::floatSquareRoot:
+		return FoldingSink::fFloat<Float>(std::sqrt(real(0)));
+	case wasm::InstWidth::Type::floatAbsolute:
+		return FoldingSink::fFloat<Float>(std::bit_cast<Float>(UInt(std::bit_cast<UInt>(real(0)) & ~SignBit)));
+	case wasm::InstWidth::Type::floatNegate:
+		return FoldingSink::fFloat<Float>(std::bit_cast<Float>(UInt(std::bit_cast<UInt>(real(0)) ^ SignBit)));
+	case wasm::InstWidth::Type::floatCopySign:
+		return FoldingSink::fFloat<Float>(std::bit_cast<Float>(UInt((std::bit_cast<UInt>(real(0)) & ~SignBit) | (std::bit_cast<UInt>(real(1)) & SignBit))));
+	}
+	return std::nullopt;
+}
+
+void wasm::opt::FoldingSink::fRelease(size_t keep) {
+	if (pConsts.size() <= keep)
+		return;
+
+	/* pass all but the last held constants to the wrapped sink */
+	size_t count = pConsts.size() - keep;
+	for (size_t i = 0; i < count; ++i)
+		pTarget->addInst(pConsts[i]);
+	pConsts.erase(pConsts.begin(), pConsts.begin() + count);
+}
+bool wasm::opt::FoldingSink::fHeld(const detail::InstInfo& info) const {
+	if (pConsts.size() < info.popCount)
+		return false;
+
+	/* check if all operands of the instruction are held constants of the expected types (the
+	*	type-index of the constant-variant matches the corresponding wasm::Type) */
+	size_t offset = pConsts.size() - info.popCount;
+	for (size_t i = 0; i < info.popCount; ++i) {
+		if (wasm::Type(pConsts[offset + i].value.index()) != info.pop[i])
+			return false;
+	}
+	return true;
+}
+bool wasm::opt::FoldingSink::fHeldRight(wasm::Type type, uint64_t value, uint64_t mask) const {
+	if (pConsts.empty())
+		return false;
+
+	/* check if the last held constant is an integer of the given type with the given (masked) value */
+	const wasm::InstConst& inst = pConsts.back();
+	if (wasm::Type(inst.value.index()) != type)
+		return false;
+	uint64_t held = (type == wasm::Type::i32 ? uint64_t(std::get<uint32_t>(inst.value)) : std::get<uint64_t>(inst.value));
+	return ((held & mask) == value);
+}
+void wasm::opt::FoldingSink::fReplace(size_t count, const wasm::InstConst& value) {
+	wasm::InstConst result = value;
+	pConsts.erase(pConsts.end() - count, pConsts.end());
+	pConsts.push_back(result);
+}
+std::optional<wasm::InstConst> wasm::opt::FoldingSink::fEvaluate(const wasm::InstSimple& inst) const {
+	const wasm::InstConst& value = pConsts.back();
+	switch (inst.type) {
+	case wasm::InstSimple::Type::expandIntSigned:
+		return wasm::InstConst{ uint64_t(int64_t(int32_t(std::get<uint32_t>(value.value)))) };
+	case wasm::InstSimple::Type::expandIntUnsigned:
+		return wasm::InstConst{ uint64_t(std::get<uint32_t>(value.value)) };
+	case wasm::InstSimple::Type::shrinkInt:
+		return wasm::InstConst{ uint32_t(std::get<uint64_t>(value.value)) };
+	case wasm::InstSimple::Type::expandFloat:
+		return FoldingSink::fFloat<double>(double(std::get<float>(value.value)));
+	case wasm::InstSimple::Type::shrinkFloat:
+		return FoldingSink::fFloat<float>(float(std::get<double>(value.value)));
+	default:
+		return std::nullopt;
+	}
+}
+std::optional<wasm::InstConst> wasm::opt::FoldingSink::fEvaluate(const wasm::InstOperand& inst) const {
+	const wasm::InstConst& a = pConsts[pConsts.size() - 2];
+	const wasm::InstConst& b = pConsts.back();
+	switch (inst.operand) {
+	case wasm::OpType::i32:
+		return FoldingSink::fEvaluate<uint32_t>(inst.type, std::get<uint32_t>(a.value), std::get<uint32_t>(b.value));
+	case wasm::OpType::i64:
+		return FoldingSink::fEvaluate<uint64_t>(inst.type, std::get<uint64_t>(a.value), std::get<uint64_t>(b.value));
+	case wasm::OpType::f32:
+		return FoldingSink::fEvaluate<float>(inst.type, std::get<float>(a.value), std::get<float>(b.value));
+	case wasm::OpType::f64:
+		return FoldingSink::fEvaluate<double>(inst.type, std::get<double>(a.value), std::get<double>(b.value));
+	}
+	return std::nullopt;
+}
+std::optional<wasm::InstConst> wasm::opt::FoldingSink::fEvaluate(const wasm::InstWidth& inst) const {
+	const wasm::InstConst* operands = pConsts.data() + pConsts.size() - detail::GetInfo(inst).popCount;
+	if (inst.width32)
+		return FoldingSink::fEvaluate<uint32_t, int32_t, float>(inst.type, operands);
+	return FoldingSink::fEvaluate<uint64_t, int64_t, double>(inst.type, operands);
+}
+bool wasm::opt::FoldingSink::fSimplify(const wasm::InstOperand& inst) {
+	if (inst.operand != wasm::OpType::i32 && inst.operand != wasm::OpType::i64)
+		return false;
+	wasm::Type type = (inst.operand == wasm::OpType::i32 ? wasm::Type::i32 : wasm::Type::i64);
+
+	switch (inst.type) {
+	case wasm::InstOperand::Type::add:
+	case wasm::InstOperand::Type::sub:
+		if (!fHeldRight(type, 0, ~uint64_t(0)))
+			return false;
+		break;
+	case wasm::InstOperand::Type::mul:
+		if (!fHeldRight(type, 1, ~uint64_t(0)))
+			return false;
+		break;
+	case wasm::InstOperand::Type::equal:
+		if (!fHeldRight(type, 0, ~uint64_t(0)))
+			return false;
+
+		/* x == 0 is equivalent to eqz */
+		pConsts.pop_back();
+		fRelease(0);
+		pTarget->addInst(wasm::InstWidth{ wasm::InstWidth::Type::equalZero, type == wasm::Type::i32 });
+		return true;
+	default:
+		return false;
+	}
+
+	/* the instruction would produce its left operand unchanged */
+	pConsts.pop_back();
+	return true;
+}
+bool wasm::opt::FoldingSink::fSimplify(const wasm::InstWidth& inst) {
+	wasm::Type type = (inst.width32 ? wasm::Type::i32 : wasm::Type::i64);
+	uint64_t ones = (inst.width32 ? uint64_t(std::numeric_limits<uint32_t>::max()) : std::numeric_limits<uint64_t>::max());
+
+	switch (inst.type) {
+	case wasm::InstWidth::Type::bitOr:
+	case wasm::InstWidth::Type::bitXOr:
+		if (!fHeldRight(type, 0, ones))
+			return false;
+		break;
+	case wasm::InstWidth::Type::bitAnd:
+		if (!fHeldRight(type, ones, ones))
+			return false;
+		break;
+	case wasm::InstWidth::Type::bitShiftLeft:
+	case wasm::InstWidth::Type::bitShiftRightSigned:
+	case wasm::InstWidth::Type::bitShiftRightUnsigned:
+	case wasm::InstWidth::Type::bitRotateLeft:
+	case wasm::InstWidth::Type::bitRotateRight:
+		if (!fHeldRight(type, 0, (inst.width32 ? 31 : 63)))
+			return false;
+		break;
+	case wasm::InstWidth::Type::divSigned:
+	case wasm::InstWidth::Type::divUnsigned:
+		if (!fHeldRight(type, 1, ones))
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	/* the instruction would produce its left operand unchanged */
+	pConsts.pop_back();
+	return true;
+}
+template <class Inst>
+bool wasm::opt::FoldingSink::fFold(const Inst& inst) {
+	/* only instructions with a single result and exclusively held operands can be evaluated */
+	const detail::InstInfo& info = detail::GetInfo(inst);
+	if (info.custom || info.pushCount != 1 || info.popCount == 0 || !fHeld(info))
+		return false;
+
+	std::optional<wasm::InstConst> value = fEvaluate(inst);
+	if (!value.has_value())
+		return false;
+	fReplace(info.popCount, *value);
+	return true;
+}
+
+void wasm::opt::FoldingSink::pushScope(const wasm::Target& target) {
+	fRelease(0);
+	pTarget->pushScope(target);
+}
+void wasm::opt::FoldingSink::popScope(wasm::ScopeType type) {
+	fRelease(0);
+	pTarget->popScope(type);
+}
+void wasm::opt::FoldingSink::toggleConditional() {
+	fRelease(0);
+	pTarget->toggleConditional();
+}
+void wasm::opt::FoldingSink::close(const wasm::Sink& sink) {
+	fRelease(0);
+	pTarget->close(sink);
+
+	pTarget = 0;
+	pWriter->fRelease(this);
+}
+void wasm::opt::FoldingSink::addLocal(const wasm::Variable& local) {
+	/* locals are declared separately from the instructions, and do not affect any held constants */
+	pTarget->addLocal(local);
+}
+void wasm::opt::FoldingSink::addComment(std::u8string_view text) {
+	fRelease(0);
+	pTarget->addComment(text);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstSimple& inst) {
+	if (fFold(inst))
+		return;
+
+	/* select with a held condition only forwards one of its operands */
+	if (inst.type == wasm::InstSimple::Type::select && pConsts.size() >= 3 && wasm::Type(pConsts.back().value.index()) == wasm::Type::i32) {
+		bool first = (std::get<uint32_t>(pConsts.back().value) != 0);
+		fReplace(3, pConsts[pConsts.size() - (first ? 3 : 2)]);
+		return;
+	}
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstConst& inst) {
+	fRelease(FoldingSink::WindowSize - 1);
+	pConsts.push_back(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstOperand& inst) {
+	if (fFold(inst) || fSimplify(inst))
+		return;
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstWidth& inst) {
+	if (fFold(inst) || fSimplify(inst))
+		return;
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstMemory& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstTable& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstLocal& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstGlobal& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstFunction& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstIndirect& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::FoldingSink::addInst(const wasm::InstBranch& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
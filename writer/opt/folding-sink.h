@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "opt-base.h"
+
+namespace wasm::opt {
+	/* sink, which holds back a small window of the last constants and evaluates all instructions
+	*	consuming only held constants (except for instructions, which would trap at runtime) */
+	class FoldingSink final : public wasm::SinkInterface {
+		friend class opt::FoldingWriter;
+		friend class opt::Decorator;
+	public:
+		/* module-interface, which creates sinks of this type (used by wasm::BasicSink to check the module) */
+		using Writer = opt::FoldingWriter;
+
+	private:
+		static constexpr size_t WindowSize = 4;
+
+	private:
+		opt::FoldingWriter* pWriter = 0;
+		wasm::SinkInterface* pTarget = 0;
+		std::vector<wasm::InstConst> pConsts;
+
+	private:
+		FoldingSink(opt::FoldingWriter* writer);
+
+	private:
+		template <class Int, class UInt>
+		static std::optional<wasm::InstConst> fTruncate(double value, bool saturate);
+		template <class Float>
+		static std::optional<wasm::InstConst> fFloat(Float value);
+		template <class Type>
+		static std::optional<wasm::InstConst> fEvaluate(wasm::InstOperand::Type type, Type a, Type b);
+		template <class UInt, class SInt, class Float>
+		static std::optional<wasm::InstConst> fEvaluate(wasm::InstWidth::Type type, const wasm::InstConst* operands);
+
+	private:
+		void fRelease(size_t keep);
+		bool fHeld(const detail::InstInfo& info) const;
+		bool fHeldRight(wasm::Type type, uint64_t value, uint64_t mask) const;
+		void fReplace(size_t count, const wasm::InstConst& value);
+		std::optional<wasm::InstConst> fEvaluate(const wasm::InstSimple& inst) const;
+		std::optional<wasm::InstConst> fEvaluate(const wasm::InstOperand& inst) const;
+		std::optional<wasm::InstConst> fEvaluate(const wasm::InstWidth& inst) const;
+		bool fSimplify(const wasm::InstOperand& inst);
+		bool fSimplify(const wasm::InstWidth& inst);
+		template <class Inst>
+		bool fFold(const Inst& inst);
+
+	public:
+		void pushScope(const wasm::Target& target) override;
+		void popScope(wasm::ScopeType type) override;
+		void toggleConditional() override;
+		void close(const wasm::Sink& sink) override;
+		void addLocal(const wasm::Variable& local) override;
+		void addComment(std::u8string_view text) override;
+		void addInst(const wasm::InstSimple& inst) override;
+		void addInst(const wasm::InstConst& inst) override;
+		void addInst(const wasm::InstOperand& inst) override;
+		void addInst(const wasm::InstWidth& inst) override;
+		void addInst(const wasm::InstMemory& inst) override;
+		void addInst(const wasm::InstTable& inst) override;
+		void addInst(const wasm::InstLocal& inst) override;
+		void addInst(const wasm::InstGlobal& inst) override;
+		void addInst(const wasm::InstFunction& inst) override;
+		void addInst(const wasm::InstIndirect& inst) override;
+		void addInst(const wasm::InstBranch& inst) override;
+	};
+}
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "opt-base.h"
+
+wasm::opt::Decorator::Decorator(wasm::ModuleInterface* target) : pTarget{ target } {}
+
+void wasm::opt::Decorator::close(const wasm::Module& module) {
+	pTarget->close(module);
+}
+void wasm::opt::Decorator::addPrototype(const wasm::Prototype& prototype) {
+	pTarget->addPrototype(prototype);
+}
+void wasm::opt::Decorator::addMemory(const wasm::Memory& memory) {
+	pTarget->addMemory(memory);
+}
+void wasm::opt::Decorator::addTable(const wasm::Table& table) {
+	pTarget->addTable(table);
+}
+void wasm::opt::Decorator::addGlobal(const wasm::Global& global) {
+	pTarget->addGlobal(global);
+}
+void wasm::opt::Decorator::addFunction(const wasm::Function& function) {
+	pTarget->addFunction(function);
+}
+void wasm::opt::Decorator::setMemoryLimit(const wasm::Memory& memory) {
+	pTarget->setMemoryLimit(memory);
+}
+void wasm::opt::Decorator::setTableLimit(const wasm::Table& table) {
+	pTarget->setTableLimit(table);
+}
+void wasm::opt::Decorator::setStartup(const wasm::Function& function) {
+	pTarget->setStartup(function);
+}
+void wasm::opt::Decorator::setValue(const wasm::Global& global, const wasm::Value& value) {
+	pTarget->setValue(global, value);
+}
+void wasm::opt::Decorator::writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) {
+	pTarget->writeData(memory, offset, data, count, borrowed);
+}
+void wasm::opt::Decorator::writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) {
+	pTarget->writeElements(table, offset, values, count);
+}
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cmath>
+#include <bit>
+#include <limits>
+
+#include "../../objects/wasm-module.h"
+#include "../../sink/wasm-sink.h"
+#include "../../inst/wasm-instlist.h"
+#include "../../inst/wasm-instinfo.h"
+
+namespace wasm::opt {
+	class PeepholeWriter;
+	class PeepholeSink;
+	class FoldingWriter;
+	class FoldingSink;
+	class PruningWriter;
+	class PruningSink;
+
+	/* base of all optimizing module-decorators, which pass all objects through to the wrapped
+	*	module-interface unchanged (the decorators only replace the sinks of the functions) */
+	class Decorator : public wasm::ModuleInterface {
+	private:
+		using Pooled = std::unique_ptr<wasm::SinkInterface, void (*)(wasm::SinkInterface*)>;
+
+	protected:
+		wasm::ModuleInterface* pTarget = 0;
+
+	private:
+		std::vector<Pooled> pIdle;
+
+	protected:
+		Decorator(wasm::ModuleInterface* target);
+
+	private:
+		template <class SinkType>
+		static void fDelete(wasm::SinkInterface* sink) {
+			delete static_cast<SinkType*>(sink);
+		}
+
+	protected:
+		/* reuse an idle sink or allocate a new sink, and bind it to the sink of the wrapped module (the sink is only taken
+		*	out of the pool once the wrapped module has provided its sink, such that it is not lost if the wrapped module throws) */
+		template <class SinkType>
+		SinkType* fAcquire(const wasm::Function& function) {
+			if (pIdle.empty()) {
+				Pooled sink{ new SinkType{ static_cast<typename SinkType::Writer*>(this) }, &Decorator::fDelete<SinkType> };
+				pIdle.push_back(std::move(sink));
+			}
+			wasm::SinkInterface* target = pTarget->sink(function);
+			SinkType* sink = static_cast<SinkType*>(pIdle.back().release());
+			pIdle.pop_back();
+			sink->pTarget = target;
+			return sink;
+		}
+
+		/* pass a closed sink back to be reused (no reference will be held to it anymore) */
+		template <class SinkType>
+		void fRelease(SinkType* sink) {
+			pIdle.push_back(Pooled{ sink, &Decorator::fDelete<SinkType> });
+		}
+
+	public:
+		void close(const wasm::Module& module) override;
+		void addPrototype(const wasm::Prototype& prototype) override;
+		void addMemory(const wasm::Memory& memory) override;
+		void addTable(const wasm::Table& table) override;
+		void addGlobal(const wasm::Global& global) override;
+		void addFunction(const wasm::Function& function) override;
+		void setMemoryLimit(const wasm::Memory& memory) override;
+		void setTableLimit(const wasm::Table& table) override;
+		void setStartup(const wasm::Function& function) override;
+		void setValue(const wasm::Global& global, const wasm::Value& value) override;
+		void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) override;
+		void writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) override;
+	};
+}
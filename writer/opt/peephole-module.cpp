@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "peephole-module.h"
+#include "peephole-sink.h"
+
+wasm::opt::PeepholeWriter::PeepholeWriter(wasm::ModuleInterface* target) : Decorator{ target } {}
+wasm::opt::PeepholeWriter::~PeepholeWriter() = default;
+
+wasm::SinkInterface* wasm::opt::PeepholeWriter::sink(const wasm::Function& function) {
+	return Decorator::fAcquire<opt::PeepholeSink>(function);
+}
@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "opt-base.h"
+
+namespace wasm::opt {
+	/* module-decorator, which rewrites the instruction-stream of all functions using local
+	*	peephole-patterns, before passing it to the wrapped module-interface (all other
+	*	objects are passed through unchanged) */
+	class PeepholeWriter final : public opt::Decorator {
+		friend class opt::PeepholeSink;
+	public:
+		PeepholeWriter(wasm::ModuleInterface* target);
+		~PeepholeWriter();
+
+	public:
+		wasm::SinkInterface* sink(const wasm::Function& function) override;
+	};
+}
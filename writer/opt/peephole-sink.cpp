@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "peephole-module.h"
+#include "peephole-sink.h"
+
+wasm::opt::PeepholeSink::PeepholeSink(opt::PeepholeWriter* writer) : pWriter{ writer } {}
+
+void wasm::opt::PeepholeSink::fRelease(size_t keep) {
+	if (pHeld.size() <= keep)
+		return;
+
+	/* pass all but the last held instructions to the wrapped sink */
+	size_t count = pHeld.size() - keep;
+	for (size_t i = 0; i < count; ++i)
+		std::visit([this](const auto& inst) { pTarget->addInst(inst); }, pHeld[i]);
+	pHeld.erase(pHeld.begin(), pHeld.begin() + count);
+}
+bool wasm::opt::PeepholeSink::fHeldEqualZero(size_t count) const {
+	if (pHeld.size() < count)
+		return false;
+
+	/* check if the last held instructions are all i32.eqz */
+	for (size_t i = pHeld.size() - count; i < pHeld.size(); ++i) {
+		const wasm::InstWidth* inst = std::get_if<wasm::InstWidth>(&pHeld[i]);
+		if (inst == 0 || inst->type != wasm::InstWidth::Type::equalZero || !inst->width32)
+			return false;
+	}
+	return true;
+}
+void wasm::opt::PeepholeSink::fDropDoubleEqualZero() {
+	/* i32.eqz; i32.eqz only normalizes the condition to zero/one, which is irrelevant for
+	*	instructions only testing the condition against zero (i.e. br_if/if/select) */
+	if (fHeldEqualZero(2))
+		pHeld.erase(pHeld.end() - 2, pHeld.end());
+}
+
+void wasm::opt::PeepholeSink::pushScope(const wasm::Target& target) {
+	if (target.type() == wasm::ScopeType::conditional)
+		fDropDoubleEqualZero();
+	fRelease(0);
+	pTarget->pushScope(target);
+}
+void wasm::opt::PeepholeSink::popScope(wasm::ScopeType type) {
+	fRelease(0);
+	pTarget->popScope(type);
+}
+void wasm::opt::PeepholeSink::toggleConditional() {
+	fRelease(0);
+	pTarget->toggleConditional();
+}
+void wasm::opt::PeepholeSink::close(const wasm::Sink& sink) {
+	fRelease(0);
+	pTarget->close(sink);
+
+	pTarget = 0;
+	pWriter->fRelease(this);
+}
+void wasm::opt::PeepholeSink::addLocal(const wasm::Variable& local) {
+	/* locals are declared separately from the instructions, and do not affect any held instructions */
+	pTarget->addLocal(local);
+}
+void wasm::opt::PeepholeSink::addComment(std::u8string_view text) {
+	fRelease(0);
+	pTarget->addComment(text);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstSimple& inst) {
+	switch (inst.type) {
+	case wasm::InstSimple::Type::nop:
+		return;
+	case wasm::InstSimple::Type::drop:
+		if (pHeld.empty())
+			break;
+
+		/* remove side-effect free producers of the dropped value or turn a local.tee into a local.set */
+		if (std::holds_alternative<wasm::InstConst>(pHeld.back())) {
+			pHeld.pop_back();
+			return;
+		}
+		if (const wasm::InstLocal* local = std::get_if<wasm::InstLocal>(&pHeld.back()); local != 0) {
+			if (local->type == wasm::InstLocal::Type::get) {
+				pHeld.pop_back();
+				return;
+			}
+			if (local->type == wasm::InstLocal::Type::tee) {
+				pHeld.back() = wasm::InstLocal{ wasm::InstLocal::Type::set, local->variable };
+				return;
+			}
+		}
+		if (const wasm::InstGlobal* global = std::get_if<wasm::InstGlobal>(&pHeld.back()); global != 0 && global->type == wasm::InstGlobal::Type::get) {
+			pHeld.pop_back();
+			return;
+		}
+		break;
+	case wasm::InstSimple::Type::select:
+	case wasm::InstSimple::Type::selectRefFunction:
+	case wasm::InstSimple::Type::selectRefExtern:
+		fDropDoubleEqualZero();
+		break;
+	default:
+		break;
+	}
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstConst& inst) {
+	fRelease(0);
+	pHeld.emplace_back(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstOperand& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstWidth& inst) {
+	if (inst.type != wasm::InstWidth::Type::equalZero || !inst.width32) {
+		fRelease(0);
+		pTarget->addInst(inst);
+		return;
+	}
+
+	/* i32.eqz applied three times is equivalent to applying it once */
+	if (fHeldEqualZero(2)) {
+		pHeld.pop_back();
+		return;
+	}
+
+	/* hold the i32.eqz back, as it might be followed by a second i32.eqz and a conditional */
+	fRelease(fHeldEqualZero(1) ? 1 : 0);
+	pHeld.emplace_back(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstMemory& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstTable& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstLocal& inst) {
+	/* merge local.set x; local.get x into local.tee x */
+	if (inst.type == wasm::InstLocal::Type::get && !pHeld.empty()) {
+		wasm::InstLocal* local = std::get_if<wasm::InstLocal>(&pHeld.back());
+		if (local != 0 && local->type == wasm::InstLocal::Type::set && local->variable.index() == inst.variable.index()) {
+			local->type = wasm::InstLocal::Type::tee;
+			return;
+		}
+	}
+	fRelease(0);
+	pHeld.emplace_back(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstGlobal& inst) {
+	fRelease(0);
+	if (inst.type == wasm::InstGlobal::Type::get)
+		pHeld.emplace_back(inst);
+	else
+		pTarget->addInst(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstFunction& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstIndirect& inst) {
+	fRelease(0);
+	pTarget->addInst(inst);
+}
+void wasm::opt::PeepholeSink::addInst(const wasm::InstBranch& inst) {
+	if (inst.type == wasm::InstBranch::Type::conditional)
+		fDropDoubleEqualZero();
+	fRelease(0);
+	pTarget->addInst(inst);
+}
@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "opt-base.h"
+
+namespace wasm::opt {
+	/* sink, which holds back the last instructions, which might still be combined with the
+	*	next instruction, and releases them to the wrapped sink once no pattern can match anymore */
+	class PeepholeSink final : public wasm::SinkInterface {
+		friend class opt::PeepholeWriter;
+		friend class opt::Decorator;
+	public:
+		/* module-interface, which creates sinks of this type (used by wasm::BasicSink to check the module) */
+		using Writer = opt::PeepholeWriter;
+
+	private:
+		using Held = std::variant<wasm::InstConst, wasm::InstWidth, wasm::InstLocal, wasm::InstGlobal>;
+
+	private:
+		opt::PeepholeWriter* pWriter = 0;
+		wasm::SinkInterface* pTarget = 0;
+		std::vector<Held> pHeld;
+
+	private:
+		PeepholeSink(opt::PeepholeWriter* writer);
+
+	private:
+		void fRelease(size_t keep);
+		bool fHeldEqualZero(size_t count) const;
+		void fDropDoubleEqualZero();
+
+	public:
+		void pushScope(const wasm::Target& target) override;
+		void popScope(wasm::ScopeType type) override;
+		void toggleConditional() override;
+		void close(const wasm::Sink& sink) override;
+		void addLocal(const wasm::Variable& local) override;
+		void addComment(std::u8string_view text) override;
+		void addInst(const wasm::InstSimple& inst) override;
+		void addInst(const wasm::InstConst& inst) override;
+		void addInst(const wasm::InstOperand& inst) override;
+		void addInst(const wasm::InstWidth& inst) override;
+		void addInst(const wasm::InstMemory& inst) override;
+		void addInst(const wasm::InstTable& inst) override;
+		void addInst(const wasm::InstLocal& inst) override;
+		void addInst(const wasm::InstGlobal& inst) override;
+		void addInst(const wasm::InstFunction& inst) override;
+		void addInst(const wasm::InstIndirect& inst) override;
+		void addInst(const wasm::InstBranch& inst) override;
+	};
+}
@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "pruning-module.h"
+#include "pruning-sink.h"
+
+wasm::opt::PruningWriter::PruningWriter(wasm::ModuleInterface* target) : Decorator{ target } {}
+wasm::opt::PruningWriter::~PruningWriter() = default;
+
+wasm::SinkInterface* wasm::opt::PruningWriter::sink(const wasm::Function& function) {
+	return Decorator::fAcquire<opt::PruningSink>(function);
+}
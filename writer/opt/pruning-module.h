@@ -0,0 +1,21 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "opt-base.h"
+
+namespace wasm::opt {
+	/* module-decorator, which removes all instructions and scopes from the instruction-stream of all
+	*	functions, which follow an unconditional transfer of control-flow within the same scope and can
+	*	therefore never be reached, before passing it to the wrapped module-interface (all other
+	*	objects are passed through unchanged) */
+	class PruningWriter final : public opt::Decorator {
+		friend class opt::PruningSink;
+	public:
+		PruningWriter(wasm::ModuleInterface* target);
+		~PruningWriter();
+
+	public:
+		wasm::SinkInterface* sink(const wasm::Function& function) override;
+	};
+}
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#include "pruning-module.h"
+#include "pruning-sink.h"
+
+wasm::opt::PruningSink::PruningSink(opt::PruningWriter* writer) : pWriter{ writer } {}
+
+void wasm::opt::PruningSink::pushScope(const wasm::Target& target) {
+	/* scopes opened within the unreachable region are dropped entirely (including their closing) */
+	if (pDead) {
+		++pNested;
+		return;
+	}
+	pTarget->pushScope(target);
+}
+void wasm::opt::PruningSink::popScope(wasm::ScopeType type) {
+	if (pNested > 0) {
+		--pNested;
+		return;
+	}
+
+	/* the end of a scope, which has been opened in reachable code, is reachable again */
+	pDead = false;
+	pTarget->popScope(type);
+}
+void wasm::opt::PruningSink::toggleConditional() {
+	if (pNested > 0)
+		return;
+
+	/* the else-branch of a conditional, which has been opened in reachable code, is reachable again */
+	pDead = false;
+	pTarget->toggleConditional();
+}
+void wasm::opt::PruningSink::close(const wasm::Sink& sink) {
+	pTarget->close(sink);
+
+	pTarget = 0;
+	pNested = 0;
+	pDead = false;
+	pWriter->fRelease(this);
+}
+void wasm::opt::PruningSink::addLocal(const wasm::Variable& local) {
+	/* locals are declared separately from the instructions, and might still be used by reachable code */
+	pTarget->addLocal(local);
+}
+void wasm::opt::PruningSink::addComment(std::u8string_view text) {
+	if (!pDead)
+		pTarget->addComment(text);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstSimple& inst) {
+	if (pDead)
+		return;
+	pTarget->addInst(inst);
+	pDead = (inst.type == wasm::InstSimple::Type::unreachable || inst.type == wasm::InstSimple::Type::ret);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstConst& inst) {
+	if (!pDead)
+		pTarget->addInst(inst);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstOperand& inst) {
+	if (!pDead)
+		pTarget->addInst(inst);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstWidth& inst) {
+	if (!pDead)
+		pTarget->addInst(inst);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstMemory& inst) {
+	if (!pDead)
+		pTarget->addInst(inst);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstTable& inst) {
+	if (!pDead)
+		pTarget->addInst(inst);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstLocal& inst) {
+	if (!pDead)
+		pTarget->addInst(inst);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstGlobal& inst) {
+	if (!pDead)
+		pTarget->addInst(inst);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstFunction& inst) {
+	if (pDead)
+		return;
+	pTarget->addInst(inst);
+	pDead = (inst.type == wasm::InstFunction::Type::callTail);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstIndirect& inst) {
+	if (pDead)
+		return;
+	pTarget->addInst(inst);
+	pDead = (inst.type == wasm::InstIndirect::Type::callTail);
+}
+void wasm::opt::PruningSink::addInst(const wasm::InstBranch& inst) {
+	if (pDead)
+		return;
+	pTarget->addInst(inst);
+	pDead = (inst.type != wasm::InstBranch::Type::conditional);
+}
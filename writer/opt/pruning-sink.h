@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright (c) 2024-2026 Bjoern Boss Henrichsen */
+#pragma once
+
+#include "opt-base.h"
+
+namespace wasm::opt {
+	/* sink, which drops everything following a branch, return, unreachable, or tail-call up to the end
+	*	of the current scope (or the else-branch of the current conditional), including all nested scopes
+	*	opened within the unreachable region (validation has already been performed by the wasm::Sink) */
+	class PruningSink final : public wasm::SinkInterface {
+		friend class opt::PruningWriter;
+		friend class opt::Decorator;
+	public:
+		/* module-interface, which creates sinks of this type (used by wasm::BasicSink to check the module) */
+		using Writer = opt::PruningWriter;
+
+	private:
+		opt::PruningWriter* pWriter = 0;
+		wasm::SinkInterface* pTarget = 0;
+		size_t pNested = 0;
+		bool pDead = false;
+
+	private:
+		PruningSink(opt::PruningWriter* writer);
+
+	public:
+		void pushScope(const wasm::Target& target) override;
+		void popScope(wasm::ScopeType type) override;
+		void toggleConditional() override;
+		void close(const wasm::Sink& sink) override;
+		void addLocal(const wasm::Variable& local) override;
+		void addComment(std::u8string_view text) override;
+		void addInst(const wasm::InstSimple& inst) override;
+		void addInst(const wasm::InstConst& inst) override;
+		void addInst(const wasm::InstOperand& inst) override;
+		void addInst(const wasm::InstWidth& inst) override;
+		void addInst(const wasm::InstMemory& inst) override;
+		void addInst(const wasm::InstTable& inst) override;
+		void addInst(const wasm::InstLocal& inst) override;
+		void addInst(const wasm::InstGlobal& inst) override;
+		void addInst(const wasm::InstFunction& inst) override;
+		void addInst(const wasm::InstIndirect& inst) override;
+		void addInst(const wasm::InstBranch& inst) override;
+	};
+}
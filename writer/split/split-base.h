@@ -3,6 +3,7 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 
 #include "../../objects/wasm-module.h"
 #include "../../sink/wasm-sink.h"
@@ -6,12 +6,22 @@
 wasm::split::Module::Module(std::initializer_list<wasm::ModuleInterface*> modules) : pModules{ modules } {
 	std::erase(pModules, nullptr);
 }
+wasm::split::Module::~Module() = default;
 
 wasm::SinkInterface* wasm::split::Module::sink(const wasm::Function& function) {
-	std::vector<wasm::SinkInterface*> sinks;
+	/* reuse an idle sink or allocate a new sink */
+	split::Sink* sink = 0;
+	if (pIdle.empty())
+		sink = new split::Sink{ this };
+	else {
+		sink = pIdle.back().release();
+		pIdle.pop_back();
+	}
+
+	/* fetch the sinks of all children */
 	for (auto& child : pModules)
-		sinks.push_back(child->sink(function));
-	return new split::Sink{ std::move(sinks) };
+		sink->pSinks.push_back(child->sink(function));
+	return sink;
 }
 void wasm::split::Module::close(const wasm::Module& module) {
 	for (auto& child : pModules)
@@ -53,9 +63,9 @@ void wasm::split::Module::setValue(const wasm::Global& global, const wasm::Value
 	for (auto& child : pModules)
 		child->setValue(global, value);
 }
-void wasm::split::Module::writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) {
+void wasm::split::Module::writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) {
 	for (auto& child : pModules)
-		child->writeData(memory, offset, data, count);
+		child->writeData(memory, offset, data, count, borrowed);
 }
 void wasm::split::Module::writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) {
 	for (auto& child : pModules)
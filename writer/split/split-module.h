@@ -9,9 +9,11 @@ namespace wasm::split {
 		friend class split::Sink;
 	private:
 		std::vector<wasm::ModuleInterface*> pModules;
+		std::vector<std::unique_ptr<split::Sink>> pIdle;
 
 	public:
 		Module(std::initializer_list<wasm::ModuleInterface*> modules);
+		~Module();
 
 	public:
 		wasm::SinkInterface* sink(const wasm::Function& function) override;
@@ -25,7 +27,7 @@ namespace wasm::split {
 		void setTableLimit(const wasm::Table& table) override;
 		void setStartup(const wasm::Function& function) override;
 		void setValue(const wasm::Global& global, const wasm::Value& value) override;
-		void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) override;
+		void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) override;
 		void writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) override;
 	};
 }
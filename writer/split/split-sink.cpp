@@ -3,7 +3,7 @@
 #include "split-module.h"
 #include "split-sink.h"
 
-wasm::split::Sink::Sink(std::vector<wasm::SinkInterface*>&& childs) : pSinks{ std::move(childs) } {}
+wasm::split::Sink::Sink(split::Module* module) : pModule{ module } {}
 
 void wasm::split::Sink::pushScope(const wasm::Target& target) {
 	for (auto& child : pSinks)
@@ -20,6 +20,10 @@ void wasm::split::Sink::toggleConditional() {
 void wasm::split::Sink::close(const wasm::Sink& sink) {
 	for (auto& child : pSinks)
 		child->close(sink);
+
+	/* pass this sink back to the module to be reused (no reference will be held anymore) */
+	pSinks.clear();
+	pModule->pIdle.emplace_back(this);
 }
 void wasm::split::Sink::addLocal(const wasm::Variable& local) {
 	for (auto& child : pSinks)
@@ -73,3 +77,7 @@ void wasm::split::Sink::addInst(const wasm::InstBranch& inst) {
 	for (auto& child : pSinks)
 		child->addInst(inst);
 }
+void wasm::split::Sink::addInsts(std::span<const wasm::InstAny> insts) {
+	for (auto& child : pSinks)
+		child->addInsts(insts);
+}
@@ -7,11 +7,16 @@
 namespace wasm::split {
 	class Sink final : public wasm::SinkInterface {
 		friend class split::Module;
+	public:
+		/* module-interface, which creates sinks of this type (used by wasm::BasicSink to check the module) */
+		using Writer = split::Module;
+
 	private:
+		split::Module* pModule = 0;
 		std::vector<wasm::SinkInterface*> pSinks;
 
 	private:
-		Sink(std::vector<wasm::SinkInterface*>&& sinks);
+		Sink(split::Module* module);
 
 	public:
 		void pushScope(const wasm::Target& target) override;
@@ -31,5 +36,6 @@ namespace wasm::split {
 		void addInst(const wasm::InstFunction& inst) override;
 		void addInst(const wasm::InstIndirect& inst) override;
 		void addInst(const wasm::InstBranch& inst) override;
+		void addInsts(std::span<const wasm::InstAny> insts) override;
 	};
 }
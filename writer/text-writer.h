@@ -7,4 +7,5 @@
 
 namespace wasm {
 	using TextWriter = wasm::text::Module;
+	using TextSink = wasm::BasicSink<wasm::text::Sink>;
 }
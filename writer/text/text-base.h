@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <memory>
 
 #include "../../objects/wasm-module.h"
 #include "../../sink/wasm-sink.h"
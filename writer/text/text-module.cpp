@@ -4,6 +4,15 @@
 #include "text-sink.h"
 
 wasm::text::Module::Module(std::u8string_view indent) : pIndent{ indent } {}
+wasm::text::Module::~Module() = default;
+
+void wasm::text::Module::fFlushBodies() {
+	/* flush all held back bodies, which directly follow the already flushed bodies */
+	while (pFlushed < pPending.size() && !pPending[pFlushed].empty()) {
+		pDefined.append(pPending[pFlushed]);
+		std::u8string{}.swap(pPending[pFlushed++]);
+	}
+}
 
 const std::u8string& wasm::text::Module::output() const {
 	if (pOutput.empty())
@@ -12,11 +21,17 @@ const std::u8string& wasm::text::Module::output() const {
 }
 
 wasm::SinkInterface* wasm::text::Module::sink(const wasm::Function& function) {
+	size_t slot = size_t(function.index() - pFunctions.indexOffset);
 	std::u8string header;
-	std::swap(header, pFunctions.data[size_t(function.index() - pFunctions.indexOffset)]);
-
-	/* allocate the new sink for the function */
-	return new text::Sink{ this, std::move(header) };
+	std::swap(header, pFunctions.data[slot]);
+
+	/* reuse an idle sink (and thereby its buffers) or allocate a new sink for the function */
+	if (pIdle.empty())
+		return new text::Sink{ this, slot, header };
+	text::Sink* sink = pIdle.back().release();
+	pIdle.pop_back();
+	sink->fSetup(slot, header);
+	return sink;
 }
 void wasm::text::Module::close(const wasm::Module& module) {
 	/* flush all globals/memory/tables to the defined-section (no need
@@ -148,45 +163,42 @@ void wasm::text::Module::setValue(const wasm::Global& global, const wasm::Value&
 		u8' ',
 		text::MakeValue(value), u8')');
 }
-void wasm::text::Module::writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) {
-	std::u8string dataText;
+void wasm::text::Module::writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool) {
+	/* write the data-definition header out (borrowed data is irrelevant, as the data are escaped into the output anyways) */
+	str::BuildTo(pDefined,
+		u8'\n', pIndent, u8"(data (memory ",
+		memory.toString(),
+		u8") (offset ",
+		text::MakeValue(offset),
+		u8") \"");
 
-	/* construct the data-string */
+	/* escape the data-string directly into the output */
 	for (size_t i = 0; i < count; ++i) {
 		switch (char8_t(data[i])) {
 		case u8'\t':
-			dataText.append(u8"\\t");
+			pDefined.append(u8"\\t");
 			break;
 		case u8'\n':
-			dataText.append(u8"\\n");
+			pDefined.append(u8"\\n");
 			break;
 		case u8'\r':
-			dataText.append(u8"\\r");
+			pDefined.append(u8"\\r");
 			break;
 		case u8'\"':
-			dataText.append(u8"\\\"");
+			pDefined.append(u8"\\\"");
 			break;
 		case u8'\\':
-			dataText.append(u8"\\\\");
+			pDefined.append(u8"\\\\");
 			break;
 		default:
 			if (cp::prop::IsAscii(char32_t(data[i])) && !cp::prop::IsControl(char32_t(data[i])))
-				dataText.push_back(char8_t(data[i]));
+				pDefined.push_back(char8_t(data[i]));
 			else
-				str::FormatTo(dataText, u8"\\{:02x}", data[i]);
+				str::FormatTo(pDefined, u8"\\{:02x}", data[i]);
 			break;
 		}
 	}
-
-	/* write the data-definition out */
-	str::BuildTo(pDefined,
-		u8'\n', pIndent, u8"(data (memory ",
-		memory.toString(),
-		u8") (offset ",
-		text::MakeValue(offset),
-		u8") \"",
-		dataText,
-		u8"\")");
+	pDefined.append(u8"\")");
 }
 void wasm::text::Module::writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) {
 	/* write the elements header out */
@@ -22,12 +22,19 @@ namespace wasm::text {
 		std::u8string pDefined;
 		std::u8string pOutput;
 		std::u8string pIndent;
+		std::vector<std::unique_ptr<text::Sink>> pIdle;
+		std::vector<std::u8string> pPending;
+		size_t pFlushed = 0;
+
+	private:
+		void fFlushBodies();
 
 	public:
 		const std::u8string& output() const;
 
 	public:
 		Module(std::u8string_view indent = u8"\t");
+		~Module();
 
 	public:
 		wasm::SinkInterface* sink(const wasm::Function& function) override;
@@ -41,7 +48,7 @@ namespace wasm::text {
 		void setTableLimit(const wasm::Table& table) override;
 		void setStartup(const wasm::Function& function) override;
 		void setValue(const wasm::Global& global, const wasm::Value& value) override;
-		void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count) override;
+		void writeData(const wasm::Memory& memory, const wasm::Value& offset, const uint8_t* data, uint32_t count, bool borrowed) override;
 		void writeElements(const wasm::Table& table, const wasm::Value& offset, const wasm::Value* values, uint32_t count) override;
 	};
 }
@@ -3,8 +3,16 @@
 #include "text-module.h"
 #include "text-sink.h"
 
-wasm::text::Sink::Sink(text::Module* module, std::u8string header) : pModule{ module } {
-	pLocals = std::move(header);
+wasm::text::Sink::Sink(text::Module* module, size_t slot, std::u8string_view header) : pModule{ module } {
+	fSetup(slot, header);
+}
+
+void wasm::text::Sink::fSetup(size_t slot, std::u8string_view header) {
+	/* reset the buffers, but keep their capacity, as sinks are reused for further functions */
+	pSlot = slot;
+	pLocals.assign(header);
+	pBody.clear();
+	pDepth.clear();
 	str::BuildTo(pDepth, u8'\n', pModule->pIndent, pModule->pIndent);
 }
 
@@ -51,10 +59,21 @@ void wasm::text::Sink::toggleConditional() {
 	fPush(u8"else");
 }
 void wasm::text::Sink::close(const wasm::Sink& sink) {
-	str::BuildTo(pModule->pDefined, pLocals, pBody, u8'\n', pModule->pIndent, u8')');
+	/* the function order defines the function indices, therefore bodies closed ahead
+	*	of a previous function are held back, until all previous bodies have been flushed */
+	if (pSlot == pModule->pFlushed) {
+		str::BuildTo(pModule->pDefined, pLocals, pBody, u8'\n', pModule->pIndent, u8')');
+		++pModule->pFlushed;
+		pModule->fFlushBodies();
+	}
+	else {
+		if (pModule->pPending.size() <= pSlot)
+			pModule->pPending.resize(pSlot + 1);
+		str::BuildTo(pModule->pPending[pSlot], pLocals, pBody, u8'\n', pModule->pIndent, u8')');
+	}
 
-	/* delete this sink (no reference will be held anymore) */
-	delete this;
+	/* pass this sink back to the module to be reused (no reference will be held anymore) */
+	pModule->pIdle.emplace_back(this);
 }
 void wasm::text::Sink::addLocal(const wasm::Variable& local) {
 	str::BuildTo(pLocals,
@@ -67,56 +86,8 @@ void wasm::text::Sink::addComment(std::u8string_view text) {
 	fAddLine(str::u8::Build(u8"(; ", text, u8" ;)"));
 }
 void wasm::text::Sink::addInst(const wasm::InstSimple& inst) {
-	/* write the general instruction-type out */
-	switch (inst.type) {
-	case wasm::InstSimple::Type::drop:
-		fAddLine(u8"drop");
-		break;
-	case wasm::InstSimple::Type::nop:
-		fAddLine(u8"nop");
-		break;
-	case wasm::InstSimple::Type::ret:
-		fAddLine(u8"return");
-		break;
-	case wasm::InstSimple::Type::unreachable:
-		fAddLine(u8"unreachable");
-		break;
-	case wasm::InstSimple::Type::select:
-		fAddLine(u8"select");
-		break;
-	case wasm::InstSimple::Type::selectRefFunction:
-		fAddLine(u8"select (result funcref)");
-		break;
-	case wasm::InstSimple::Type::selectRefExtern:
-		fAddLine(u8"select (result externref)");
-		break;
-	case wasm::InstSimple::Type::refTestNull:
-		fAddLine(u8"ref.is_null");
-		break;
-	case wasm::InstSimple::Type::refNullFunction:
-		fAddLine(u8"ref.null func");
-		break;
-	case wasm::InstSimple::Type::refNullExtern:
-		fAddLine(u8"ref.null extern");
-		break;
-	case wasm::InstSimple::Type::expandIntSigned:
-		fAddLine(u8"i64.extend_i32_s");
-		break;
-	case wasm::InstSimple::Type::expandIntUnsigned:
-		fAddLine(u8"i64.extend_i32_u");
-		break;
-	case wasm::InstSimple::Type::shrinkInt:
-		fAddLine(u8"i32.wrap_i64");
-		break;
-	case wasm::InstSimple::Type::expandFloat:
-		fAddLine(u8"f64.promote_f32");
-		break;
-	case wasm::InstSimple::Type::shrinkFloat:
-		fAddLine(u8"f32.demote_f64");
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstSimple type [", size_t(inst.type), "] encountered" };
-	}
+	/* write the instruction out */
+	fAddLine(detail::GetInfo(inst).name);
 }
 void wasm::text::Sink::addInst(const wasm::InstConst& inst) {
 	std::u8string line;
@@ -155,199 +126,12 @@ void wasm::text::Sink::addInst(const wasm::InstConst& inst) {
 	fAddLine(line);
 }
 void wasm::text::Sink::addInst(const wasm::InstOperand& inst) {
-	std::u8string line{ text::MakeOperand(inst.operand) };
-
-	/* add the general instruction-type */
-	switch (inst.type) {
-	case wasm::InstOperand::Type::equal:
-		line.append(u8".eq");
-		break;
-	case wasm::InstOperand::Type::notEqual:
-		line.append(u8".ne");
-		break;
-	case wasm::InstOperand::Type::add:
-		line.append(u8".add");
-		break;
-	case wasm::InstOperand::Type::sub:
-		line.append(u8".sub");
-		break;
-	case wasm::InstOperand::Type::mul:
-		line.append(u8".mul");
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstOperand type [", size_t(inst.type), "] encountered" };
-	}
-
-	/* write the line out */
-	fAddLine(line);
+	/* write the instruction out */
+	fAddLine(detail::GetInfo(inst).name);
 }
 void wasm::text::Sink::addInst(const wasm::InstWidth& inst) {
-	std::u8string_view width{ inst.width32 ? u8"32" : u8"64" };
-
-	/* write the general instruction-type out */
-	switch (inst.type) {
-	case wasm::InstWidth::Type::equalZero:
-		fAddLine(str::u8::Build(u8'i', width, u8".eqz"));
-		break;
-	case wasm::InstWidth::Type::greater:
-		fAddLine(str::u8::Build(u8'f', width, u8".gt"));
-		break;
-	case wasm::InstWidth::Type::less:
-		fAddLine(str::u8::Build(u8'f', width, u8".lt"));
-		break;
-	case wasm::InstWidth::Type::greaterEqual:
-		fAddLine(str::u8::Build(u8'f', width, u8".ge"));
-		break;
-	case wasm::InstWidth::Type::lessEqual:
-		fAddLine(str::u8::Build(u8'f', width, u8".le"));
-		break;
-	case wasm::InstWidth::Type::greaterSigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".gt_s"));
-		break;
-	case wasm::InstWidth::Type::greaterUnsigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".gt_u"));
-		break;
-	case wasm::InstWidth::Type::lessSigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".lt_s"));
-		break;
-	case wasm::InstWidth::Type::lessUnsigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".lt_u"));
-		break;
-	case wasm::InstWidth::Type::greaterEqualSigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".ge_s"));
-		break;
-	case wasm::InstWidth::Type::greaterEqualUnsigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".ge_u"));
-		break;
-	case wasm::InstWidth::Type::lessEqualSigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".le_s"));
-		break;
-	case wasm::InstWidth::Type::lessEqualUnsigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".le_u"));
-		break;
-	case wasm::InstWidth::Type::divSigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".div_s"));
-		break;
-	case wasm::InstWidth::Type::divUnsigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".div_u"));
-		break;
-	case wasm::InstWidth::Type::modSigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".rem_s"));
-		break;
-	case wasm::InstWidth::Type::modUnsigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".rem_u"));
-		break;
-	case wasm::InstWidth::Type::convertToF32Signed:
-		fAddLine(str::u8::Build(u8"f32.convert_i", width, u8"_s"));
-		break;
-	case wasm::InstWidth::Type::convertToF32Unsigned:
-		fAddLine(str::u8::Build(u8"f32.convert_i", width, u8"_u"));
-		break;
-	case wasm::InstWidth::Type::convertToF64Signed:
-		fAddLine(str::u8::Build(u8"f64.convert_i", width, u8"_s"));
-		break;
-	case wasm::InstWidth::Type::convertToF64Unsigned:
-		fAddLine(str::u8::Build(u8"f64.convert_i", width, u8"_u"));
-		break;
-	case wasm::InstWidth::Type::convertFromF32SignedTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_f32_s"));
-		break;
-	case wasm::InstWidth::Type::convertFromF32UnsignedTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_f32_u"));
-		break;
-	case wasm::InstWidth::Type::convertFromF64SignedTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_f64_s"));
-		break;
-	case wasm::InstWidth::Type::convertFromF64UnsignedTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_f64_u"));
-		break;
-	case wasm::InstWidth::Type::convertFromF32SignedNoTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_sat_f32_s"));
-		break;
-	case wasm::InstWidth::Type::convertFromF32UnsignedNoTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_sat_f32_u"));
-		break;
-	case wasm::InstWidth::Type::convertFromF64SignedNoTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_sat_f64_s"));
-		break;
-	case wasm::InstWidth::Type::convertFromF64UnsignedNoTrap:
-		fAddLine(str::u8::Build(u8'i', width, u8".trunc_sat_f64_u"));
-		break;
-	case wasm::InstWidth::Type::reinterpretAsFloat:
-		fAddLine(str::u8::Build(u8'f', width, u8".reinterpret_i", width));
-		break;
-	case wasm::InstWidth::Type::bitAnd:
-		fAddLine(str::u8::Build(u8'i', width, u8".and"));
-		break;
-	case wasm::InstWidth::Type::bitOr:
-		fAddLine(str::u8::Build(u8'i', width, u8".or"));
-		break;
-	case wasm::InstWidth::Type::bitXOr:
-		fAddLine(str::u8::Build(u8'i', width, u8".xor"));
-		break;
-	case wasm::InstWidth::Type::bitShiftLeft:
-		fAddLine(str::u8::Build(u8'i', width, u8".shl"));
-		break;
-	case wasm::InstWidth::Type::bitShiftRightSigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".shr_s"));
-		break;
-	case wasm::InstWidth::Type::bitShiftRightUnsigned:
-		fAddLine(str::u8::Build(u8'i', width, u8".shr_u"));
-		break;
-	case wasm::InstWidth::Type::bitRotateLeft:
-		fAddLine(str::u8::Build(u8'i', width, u8".rotl"));
-		break;
-	case wasm::InstWidth::Type::bitRotateRight:
-		fAddLine(str::u8::Build(u8'i', width, u8".rotr"));
-		break;
-	case wasm::InstWidth::Type::bitLeadingNulls:
-		fAddLine(str::u8::Build(u8'i', width, u8".clz"));
-		break;
-	case wasm::InstWidth::Type::bitTrailingNulls:
-		fAddLine(str::u8::Build(u8'i', width, u8".ctz"));
-		break;
-	case wasm::InstWidth::Type::bitSetCount:
-		fAddLine(str::u8::Build(u8'i', width, u8".popcnt"));
-		break;
-	case wasm::InstWidth::Type::floatDiv:
-		fAddLine(str::u8::Build(u8'f', width, u8".div"));
-		break;
-	case wasm::InstWidth::Type::reinterpretAsInt:
-		fAddLine(str::u8::Build(u8'i', width, u8".reinterpret_f", width));
-		break;
-	case wasm::InstWidth::Type::floatMin:
-		fAddLine(str::u8::Build(u8'f', width, u8".min"));
-		break;
-	case wasm::InstWidth::Type::floatMax:
-		fAddLine(str::u8::Build(u8'f', width, u8".max"));
-		break;
-	case wasm::InstWidth::Type::floatFloor:
-		fAddLine(str::u8::Build(u8'f', width, u8".floor"));
-		break;
-	case wasm::InstWidth::Type::floatRound:
-		fAddLine(str::u8::Build(u8'f', width, u8".nearest"));
-		break;
-	case wasm::InstWidth::Type::floatCeil:
-		fAddLine(str::u8::Build(u8'f', width, u8".ceil"));
-		break;
-	case wasm::InstWidth::Type::floatTruncate:
-		fAddLine(str::u8::Build(u8'f', width, u8".trunc"));
-		break;
-	case wasm::InstWidth::Type::floatAbsolute:
-		fAddLine(str::u8::Build(u8'f', width, u8".abs"));
-		break;
-	case wasm::InstWidth::Type::floatNegate:
-		fAddLine(str::u8::Build(u8'f', width, u8".neg"));
-		break;
-	case wasm::InstWidth::Type::floatSquareRoot:
-		fAddLine(str::u8::Build(u8'f', width, u8".sqrt"));
-		break;
-	case wasm::InstWidth::Type::floatCopySign:
-		fAddLine(str::u8::Build(u8'f', width, u8".copysign"));
-		break;
-	default:
-		throw wasm::Exception{ "Unknown wasm::InstWidth type [", size_t(inst.type), "] encountered" };
-	}
+	/* write the instruction out */
+	fAddLine(detail::GetInfo(inst).name);
 }
 void wasm::text::Sink::addInst(const wasm::InstMemory& inst) {
 	std::u8string_view name;
@@ -547,8 +331,10 @@ void wasm::text::Sink::addInst(const wasm::InstBranch& inst) {
 		break;
 	case wasm::InstBranch::Type::table:
 		line.append(u8"br_table ");
-		for (size_t i = 0; i < inst.list.size(); ++i)
-			str::BuildTo(line, inst.list.begin()[i].get().toString(), u8' ');
+		for (const wasm::WTarget& target : inst.targets())
+			str::BuildTo(line, target.get().toString(), u8' ');
+		for (uint32_t depth : inst.depths)
+			str::BuildTo(line, depth, u8' ');
 		break;
 	default:
 		throw wasm::Exception{ "Unknown wasm::InstBranch type [", size_t(inst.type), "] encountered" };
@@ -558,3 +344,8 @@ void wasm::text::Sink::addInst(const wasm::InstBranch& inst) {
 	line.append(inst.target.toString());
 	fAddLine(line);
 }
+void wasm::text::Sink::addInsts(std::span<const wasm::InstAny> insts) {
+	/* write the instructions without dispatching each one through the sink-interface */
+	for (const wasm::InstAny& inst : insts)
+		detail::VisitInst(inst, [this](const auto& value) { text::Sink::addInst(value); });
+}
@@ -7,16 +7,22 @@
 namespace wasm::text {
 	class Sink final : public wasm::SinkInterface {
 		friend class text::Module;
+	public:
+		/* module-interface, which creates sinks of this type (used by wasm::BasicSink to check the module) */
+		using Writer = text::Module;
+
 	private:
 		text::Module* pModule = 0;
+		size_t pSlot = 0;
 		std::u8string pLocals;
 		std::u8string pBody;
 		std::u8string pDepth;
 
 	private:
-		Sink(text::Module* module, std::u8string header);
+		Sink(text::Module* module, size_t slot, std::u8string_view header);
 
 	private:
+		void fSetup(size_t slot, std::u8string_view header);
 		void fAddLine(std::u8string_view str);
 		void fPush(std::u8string_view name);
 		void fPop();
@@ -39,5 +45,6 @@ namespace wasm::text {
 		void addInst(const wasm::InstFunction& inst) override;
 		void addInst(const wasm::InstIndirect& inst) override;
 		void addInst(const wasm::InstBranch& inst) override;
+		void addInsts(std::span<const wasm::InstAny> insts) override;
 	};
 }